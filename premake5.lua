@@ -2,10 +2,35 @@ workspace "ChessAI"
 	configurations { "Debug", "Release" }
 	platforms { "Win32", "x64" }
 
+-- Engine sources with no graphics dependencies, shared by the windowed program and the UCI engine
+engineFiles = {
+	"src/attacks.*",
+	"src/batch.*",
+	"src/bench.*",
+	"src/bitboard.h",
+	"src/board.*",
+	"src/Evaluator.*",
+	"src/game.*",
+	"src/GameRecord.*",
+	"src/MiniMaxTree.*",
+	"src/nnue.*",
+	"src/notation.*",
+	"src/PackedPosition.h",
+	"src/PawnHashTable.*",
+	"src/pgn.*",
+	"src/PositionDB.*",
+	"src/SearchStats.*",
+	"src/TrainingData.*",
+	"src/see.cpp",
+	"src/util.h",
+	"src/zobrist.*"
+}
+
 project "ChessAI"
 
 	kind "ConsoleApp"
 	language "C++"
+	cppdialect "C++17"
 
 	outputdir = "out/%{cfg.buildcfg}"
 	
@@ -17,6 +42,8 @@ project "ChessAI"
 		"premake5.lua"
 	}
 
+	removefiles { "src/epd.*", "src/server.*", "src/tournament.*", "src/uci.*", "src/uciMain.cpp" }
+
 
 	includedirs {
 		"lib/ImGui",
@@ -55,4 +82,37 @@ project "ChessAI"
 	filter { }
 
 	include "lib/ImGui/Build_ImGui.lua"
-	include "lib/glfw"
\ No newline at end of file
+	include "lib/glfw"
+
+-- Headless engine speaking UCI on stdin/stdout, for GUIs, tournament managers and machines without a display
+project "ChessAI-UCI"
+
+	kind "ConsoleApp"
+	language "C++"
+	cppdialect "C++17"
+
+	targetdir (outputdir)
+
+	files (engineFiles)
+	files { "src/epd.*", "src/server.*", "src/tournament.*", "src/uci.*", "src/uciMain.cpp" }
+
+	filter "configurations:Debug"
+		defines { "DEBUG" }
+		symbols "On"
+
+	filter "configurations:Release"
+		defines { "NDEBUG" }
+		optimize "On"
+
+	filter "platforms:Win32"
+		architecture "x86"
+
+	filter "platforms:x64"
+		architecture "x86_64"
+
+	filter "system:windows"
+		links { "ws2_32" }
+
+	filter "system:not windows"
+		links { "pthread" }
+	filter { }
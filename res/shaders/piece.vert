@@ -2,10 +2,12 @@
 
 layout(location=0) in vec3 aPos;
 layout(location=1) in vec2 aTexCoord;
+layout(location=2) in vec3 aCorner;
+layout(location=3) in vec4 aCell;
 
 out vec2 textureCoord;
 
 void main() {
-    gl_Position = vec4(aPos, 1.f);
-    textureCoord = aTexCoord; 
+    gl_Position = vec4(aPos + aCorner, 1.f);
+    textureCoord = mix(aCell.xy, aCell.zw, aTexCoord); 
 }
\ No newline at end of file
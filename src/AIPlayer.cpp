@@ -1,5 +1,5 @@
 #include "Player.h"
-#include "piece.h"
+#include "MiniMaxTree.h"
 #include <unordered_map>
 #include <memory>
 
@@ -156,122 +156,15 @@ public:
 };
 */
 
-struct MMTNode {
-	std::shared_ptr<Game> nodeState;
-	MMTNode* parent;
-	std::unordered_map<Move, MMTNode*, MoveHasher> children;
-	Move bestMove;
-	Color whoseMove;
-	float eval;
-
-	MMTNode(std::shared_ptr<Game> nodeState, MMTNode* parent, Color whoseMove) {
-		this->nodeState = std::make_shared<Game>(Game(nodeState));
-		this->parent = parent;
-		this->whoseMove = whoseMove;
-		eval = 0.f;
-
-		bestMove = Move();
-	}
-
-	~MMTNode() {
-		for (auto& child : children) {
-			delete child.second;
-			child.second = 0;
-		}
-		children.clear();
-	}
-
-	bool isLeaf() {
-		return children.size() == 0;
-	}
-
-	/*
-	void updateBestChild(MMTNode* child, Move childMove) {
-		if (whoseMove == white && child->eval > bestChildEval) {
-			bestChild = child;
-			bestMove = childMove;
-			bestChildEval = child->eval;
-		}
-		if (whoseMove == black && child->eval < bestChildEval) {
-			bestChild = child;
-			bestMove = childMove;
-			bestChildEval = child->eval;
-		}
-	}
-	*/
-
-	void evaluate() {
-		if (isLeaf()) eval = nodeState->getMaterialDifference();
-		else {
-			float bestChildEval = (whoseMove == white) ? -10000.f : 10000.f;
-			for (auto& child : children) {
-				if (child.second == 0) continue;
-				if (whoseMove == white && child.second->eval > bestChildEval) {
-					bestMove = child.first;
-					bestChildEval = child.second->eval;
-				}
-				if (whoseMove == black && child.second->eval < bestChildEval) {
-					bestMove = child.first;
-					bestChildEval = child.second->eval;
-				}
-			}
-
-			eval = bestChildEval;
-		}
-	}
-
-	void expand() {
-		std::vector<Move> legalMoves;
-		nodeState->getAllLegalMoves(&legalMoves, whoseMove);
-		Color nextPlayer = (whoseMove == white) ? black : white;
-		for (Move childMove : legalMoves) {
-			MMTNode* child = new MMTNode(nodeState, this, nextPlayer);
-			child->nodeState->makePlayerMove(childMove);
-			child->evaluate();
-			//updateBestChild(child, childMove);
-			children[childMove] = child;
-		}
-	}
-};
-
-class MiniMaxTree {
-	MMTNode* root = 0;
-
-public:
-	MiniMaxTree(MMTNode* root) {
-		this->root = root;
-	}
-
-	void search(uint64_t searchLimit) {
-		assert(root != 0);
-		for (int i = 0; i < searchLimit; i++) {
-			MMTNode* working = root;
-			MMTNode* next = 0;
-			while (!working->isLeaf()) {
-				next = working->children[working->bestMove];
-				if (!next) break;
-				working = next;
-			}
-			working->expand();
-			while (working) {
-				working->evaluate();
-				working = working->parent;
-			}
-		}
-	}
-};
-
-
 //#define RANDOM_MOVE
 //#define MONTE_CARLO_TREE
 #define MINIMAX_TREE
 
 void AIPlayer::itsMyTurn() {
 #ifdef MINIMAX_TREE
-	MMTNode root = MMTNode(activeGame, 0, playerColor);
-	MiniMaxTree findingNextMove = MiniMaxTree(&root);
+	MMTNode root = MMTNode(activeGame, 0, playerColor, evaluator.get());
+	MiniMaxTree findingNextMove(&root);
 	findingNextMove.search(10);
-	Move nextMove = Move(*activeGame, root.bestMove.source, root.bestMove.target);
-	activeGame->makePlayerMove(Move(nextMove));
+	activeGame->makePlayerMove(root.bestMove);
 #endif
 }  
\ No newline at end of file
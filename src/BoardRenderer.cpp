@@ -0,0 +1,127 @@
+#include "BoardRenderer.h"
+#include "VBO.h"
+#include <algorithm>
+
+// Colors for the squares of the board
+const glm::vec3 LIGHT_SQUARE_COLOR = glm::vec3(1.f);
+const glm::vec3 DARK_SQUARE_COLOR = glm::vec3(.25f, 0.f, .35f);
+// Pieces sit this far in front of the board
+constexpr float PIECE_DEPTH = -.1f;
+constexpr int BOARD_INDEX_COUNT = 64 * 6;
+
+// Floats per instance: the corner, then the atlas cell
+constexpr int INSTANCE_FLOATS = 7;
+
+static bool operator==(const PieceInstance& left, const PieceInstance& right) {
+	return left.corner.x == right.corner.x && left.corner.y == right.corner.y && left.corner.z == right.corner.z
+		&& left.cell.u0 == right.cell.u0 && left.cell.v0 == right.cell.v0 && left.cell.u1 == right.cell.u1 && left.cell.v1 == right.cell.v1
+		&& left.held == right.held;
+}
+
+/*-------------------------------------------------------------------------------------------------------------*\
+* BoardRenderer::BoardRenderer()
+*
+* Description: Builds the board mesh, four colored corners per square, and the piece quad. The quad spans one
+*              square from its top left corner; each instance moves it by that square's corner and maps its
+*              texture coordinates onto the piece's atlas cell
+\*-------------------------------------------------------------------------------------------------------------*/
+BoardRenderer::BoardRenderer() {
+	std::vector<GLfloat> vertices;
+	std::vector<GLuint> indices;
+	vertices.reserve(64 * 4 * 6);
+	indices.reserve(BOARD_INDEX_COUNT);
+	for (int i = 0; i < 64; i++) {
+		float left = (i % 8 - 4) * SQUARE_SIZE;
+		float top = (4 - i / 8) * SQUARE_SIZE;
+		glm::vec3 color = ((i % 2) ^ (i / 8 % 2)) ? LIGHT_SQUARE_COLOR : DARK_SQUARE_COLOR;
+		const float corners[4][2] = { { left, top }, { left + SQUARE_SIZE, top }, { left, top - SQUARE_SIZE }, { left + SQUARE_SIZE, top - SQUARE_SIZE } };
+		for (const float* corner : corners) {
+			vertices.insert(vertices.end(), { corner[0], corner[1], 0.f, color.x, color.y, color.z });
+		}
+		GLuint first = i * 4;
+		indices.insert(indices.end(), { first, first + 1, first + 2, first + 1, first + 2, first + 3 });
+	}
+
+	boardArray.bind();
+	boardVertices = new VBO(vertices.data(), vertices.size() * sizeof(GLfloat));
+	boardIndices = new EBO(indices.data(), indices.size() * sizeof(GLuint));
+	boardArray.linkAttribute(boardVertices, 0, 3, GL_FLOAT, 6 * sizeof(float), (void*)0);
+	boardArray.linkAttribute(boardVertices, 1, 3, GL_FLOAT, 6 * sizeof(float), (void*)(3 * sizeof(float)));
+	boardArray.unbind();
+
+	GLfloat quad[] = {
+		0.f,			0.f,			PIECE_DEPTH,	0.f, 1.f,
+		SQUARE_SIZE,	0.f,			PIECE_DEPTH,	1.f, 1.f,
+		0.f,			-SQUARE_SIZE,	PIECE_DEPTH,	0.f, 0.f,
+		SQUARE_SIZE,	-SQUARE_SIZE,	PIECE_DEPTH,	1.f, 0.f
+	};
+	GLuint quadOrder[] = { 0, 1, 2, 1, 2, 3 };
+
+	pieceArray.bind();
+	quadVertices = new VBO(quad, sizeof(quad));
+	quadIndices = new EBO(quadOrder, sizeof(quadOrder));
+	instanceBuffer = new VBO(nullptr, 0, GL_DYNAMIC_DRAW);
+	pieceArray.linkAttribute(quadVertices, 0, 3, GL_FLOAT, 5 * sizeof(float), (void*)0);
+	pieceArray.linkAttribute(quadVertices, 1, 2, GL_FLOAT, 5 * sizeof(float), (void*)(3 * sizeof(float)));
+	pieceArray.linkAttribute(instanceBuffer, 2, 3, GL_FLOAT, INSTANCE_FLOATS * sizeof(float), (void*)0, 1);
+	pieceArray.linkAttribute(instanceBuffer, 3, 4, GL_FLOAT, INSTANCE_FLOATS * sizeof(float), (void*)(3 * sizeof(float)), 1);
+	pieceArray.unbind();
+}
+
+BoardRenderer::~BoardRenderer() {
+	delete boardVertices;
+	delete boardIndices;
+	delete quadVertices;
+	delete quadIndices;
+	delete instanceBuffer;
+}
+
+/*-------------------------------------------------------------------------------------------------------------*\
+* BoardRenderer::setPieces(std::vector<PieceInstance>)
+*
+* Parameters: pieces - Every piece to draw, in any order
+* Description: Puts the held piece last, so it's drawn over the others, and uploads the pieces when anything moved
+*              or changed
+* Return Value: True if the pieces changed since the last call, so what draw() produces has too
+\*-------------------------------------------------------------------------------------------------------------*/
+bool BoardRenderer::setPieces(std::vector<PieceInstance> pieces) {
+	std::stable_partition(pieces.begin(), pieces.end(), [](const PieceInstance& piece) { return !piece.held; });
+	if (pieces == instances) return false;
+
+	instances = std::move(pieces);
+	std::vector<GLfloat> data;
+	data.reserve(instances.size() * INSTANCE_FLOATS);
+	for (const PieceInstance& piece : instances) {
+		data.insert(data.end(), { piece.corner.x, piece.corner.y, piece.corner.z, piece.cell.u0, piece.cell.v0, piece.cell.u1, piece.cell.v1 });
+	}
+	instanceBuffer->setData(data.data(), data.size() * sizeof(GLfloat));
+	instanceBuffer->unbind();
+	return true;
+}
+
+/*-------------------------------------------------------------------------------------------------------------*\
+* BoardRenderer::draw(Shader*, Shader*, const PieceAtlas&)
+*
+* Parameters: boardShader - Colors the squares
+*             pieceShader - Samples the atlas, with its sampler already set to texture unit 0
+*             atlas - Holds every piece image
+* Description: Draws all the squares with one shader, then every piece in one instanced call with the other, so
+*              each program, buffer and texture is bound once. Instances are drawn in order, so the held piece lands
+*              on top. Expects blending to be on; the squares are opaque, so it doesn't change them
+\*-------------------------------------------------------------------------------------------------------------*/
+void BoardRenderer::draw(Shader* boardShader, Shader* pieceShader, const PieceAtlas& atlas) {
+	boardShader->activate();
+	boardArray.bind();
+	glDrawElements(GL_TRIANGLES, BOARD_INDEX_COUNT, GL_UNSIGNED_INT, 0);
+
+	if (!instances.empty()) {
+		pieceShader->activate();
+		glActiveTexture(GL_TEXTURE0);
+		glBindTexture(GL_TEXTURE_2D, atlas.getTexture());
+		pieceArray.bind();
+		glDrawElementsInstanced(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0, (GLsizei)instances.size());
+	}
+
+	pieceArray.unbind();
+	pieceShader->deactivate();
+}
@@ -0,0 +1,48 @@
+#pragma once
+#include "graphics.h"
+#include "shader.h"
+#include "VAO.h"
+#include "EBO.h"
+#include "PieceAtlas.h"
+
+// Width of a board square in normalized device coordinates, so the board spans -1 to 1
+constexpr float SQUARE_SIZE = .25f;
+
+// One piece to draw: the top left corner of the square it covers, and its image in the atlas
+struct PieceInstance {
+	glm::vec3 corner;
+	AtlasCell cell;
+	bool held;		// Drawn last, above every other piece
+};
+
+/*-------------------------------------------------------------------------------------------------------------*\
+* BoardRenderer
+*
+* Description: Draws the board and its pieces from GPU buffers made once. The 64 squares are a single static mesh
+*              drawn in one call. Pieces share one quad and one atlas texture and are drawn as one instanced call,
+*              with only the per-piece corners and atlas cells uploaded, and only when they've changed. Needs a
+*              current opengl context to construct
+\*-------------------------------------------------------------------------------------------------------------*/
+class BoardRenderer {
+	VAO boardArray;
+	VBO* boardVertices = nullptr;
+	EBO* boardIndices = nullptr;
+
+	VAO pieceArray;
+	VBO* quadVertices = nullptr;
+	EBO* quadIndices = nullptr;
+	VBO* instanceBuffer = nullptr;
+
+	// What the instance buffer holds, in draw order: the held piece last
+	std::vector<PieceInstance> instances;
+
+public:
+	BoardRenderer();
+	BoardRenderer(const BoardRenderer&) = delete;
+	BoardRenderer& operator=(const BoardRenderer&) = delete;
+	~BoardRenderer();
+
+	// Uploads the pieces if they differ from the last call. Returns true if they did
+	bool setPieces(std::vector<PieceInstance> pieces);
+	void draw(Shader* boardShader, Shader* pieceShader, const PieceAtlas&);
+};
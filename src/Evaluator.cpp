@@ -0,0 +1,229 @@
+#include "Evaluator.h"
+#include <fstream>
+#include <sstream>
+
+// Contribution of each piece type to the game phase
+constexpr int phaseWeight[7] = { 0, 0, 1, 1, 2, 4, 0 };
+
+static Bitboard adjacentFilesBB(int file) {
+	return ((file > 0) ? fileBB(file - 1) : 0) | ((file < 7) ? fileBB(file + 1) : 0);
+}
+
+// All ranks in front of 'rank' from the point of view of 'color'
+static Bitboard forwardRanksBB(Color color, int rank) {
+	if (color == white) return (rank >= 7) ? 0 : ~0ULL << (8 * (rank + 1));
+	return (rank <= 0) ? 0 : ~0ULL >> (8 * (8 - rank));
+}
+
+static Bitboard pawnAttacksBB(Color color, Bitboard pawns) {
+	if (color == white) return ((pawns << 7) & ~FILE_H_BB) | ((pawns << 9) & ~FILE_A_BB);
+	return ((pawns >> 7) & ~FILE_A_BB) | ((pawns >> 9) & ~FILE_H_BB);
+}
+
+static PieceType pieceTypeFromName(const std::string& name) {
+	if (name == "pawn")		return pawn;
+	if (name == "knight")	return knight;
+	if (name == "bishop")	return bishop;
+	if (name == "rook")		return rook;
+	if (name == "queen")	return queen;
+	if (name == "king")		return king;
+	return open;
+}
+
+/*-------------------------------------------------------------------------------------------------------------*\
+* PSTEvaluator::PSTEvaluator(const char*)
+*
+* Parameters: filepath - Path to the piece-square table data file
+* Description: Creates the evaluator from the tables in 'filepath'. If the file can't be read the evaluator
+*              falls back to plain material values so the engine keeps playing
+\*-------------------------------------------------------------------------------------------------------------*/
+PSTEvaluator::PSTEvaluator(const char* filepath) {
+	const int defaultMiddlegame[7] = { 0, 82, 337, 365, 477, 1025, 0 };
+	const int defaultEndgame[7] = { 0, 94, 281, 297, 512, 936, 0 };
+	for (int type = 0; type < 7; type++) {
+		middlegame.value[type] = defaultMiddlegame[type];
+		endgame.value[type] = defaultEndgame[type];
+	}
+
+	tablesLoaded = loadTables(filepath);
+	if (!tablesLoaded) {
+		std::cerr << "Failed to load piece-square tables from " << filepath << ", using material only" << std::endl;
+	}
+}
+
+/*-------------------------------------------------------------------------------------------------------------*\
+* PSTEvaluator::loadTables(const char*)
+*
+* Parameters: filepath - Path to the piece-square table data file
+* Description: Reads piece values and tables from a text file (see res/eval/pst.txt for the format). Tables are
+*              written rank 8 first, the way white sees the board
+* Return Value: True if the whole file parsed, false otherwise. Tables read before an error are kept
+\*-------------------------------------------------------------------------------------------------------------*/
+bool PSTEvaluator::loadTables(const char* filepath) {
+	std::ifstream in(filepath);
+	if (!in) return false;
+
+	// Strip comments so the rest can be read as a stream of tokens
+	std::stringstream tokens;
+	std::string line;
+	while (std::getline(in, line)) {
+		tokens << line.substr(0, line.find('#')) << '\n';
+	}
+
+	std::string phaseName, entry, pieceName;
+	while (tokens >> phaseName >> entry) {
+		PhaseParameters* phase = nullptr;
+		if (phaseName == "mg") phase = &middlegame;
+		if (phaseName == "eg") phase = &endgame;
+		if (!phase) return false;
+
+		if (entry == "value" || entry == "table") {
+			if (!(tokens >> pieceName)) return false;
+			PieceType type = pieceTypeFromName(pieceName);
+			if (type == open) return false;
+
+			if (entry == "value" && !(tokens >> phase->value[type])) return false;
+			for (int i = 0; entry == "table" && i < 64; i++) {
+				if (!(tokens >> phase->table[type][i ^ 56])) return false;
+			}
+		}
+		else if (entry == "doubled") {
+			if (!(tokens >> phase->doubledPawn)) return false;
+		}
+		else if (entry == "isolated") {
+			if (!(tokens >> phase->isolatedPawn)) return false;
+		}
+		else if (entry == "backward") {
+			if (!(tokens >> phase->backwardPawn)) return false;
+		}
+		else if (entry == "passed") {
+			for (int rank = 0; rank < 8; rank++) {
+				if (!(tokens >> phase->passedPawn[rank])) return false;
+			}
+		}
+		else return false;
+	}
+	return tokens.eof();
+}
+
+/*-------------------------------------------------------------------------------------------------------------*\
+* PSTEvaluator::evaluatePawns(Color, Bitboard, Bitboard, int&, int&, Bitboard&)
+*
+* Parameters: us - Side whose pawns are scored
+*             ours - Bitboard of our pawns
+*             theirs - Bitboard of the opponent's pawns
+*             middlegameScore, endgameScore - Our pawn structure score for each phase
+*             passed - Bitboard of our passed pawns
+* Description: Scores doubled, isolated, backward and passed pawns. Only pawns are looked at, so the result can be
+*              cached by pawn hash
+\*-------------------------------------------------------------------------------------------------------------*/
+void PSTEvaluator::evaluatePawns(Color us, Bitboard ours, Bitboard theirs, int& middlegameScore, int& endgameScore, Bitboard& passed) const {
+	Color them = (us == white) ? black : white;
+	Bitboard theirAttacks = pawnAttacksBB(them, theirs);
+	middlegameScore = endgameScore = 0;
+	passed = 0;
+
+	Bitboard pawns = ours;
+	while (pawns) {
+		int square = popLsb(pawns);
+		int file = square % 8;
+		int rank = square / 8;
+		int relativeRank = (us == white) ? rank : 7 - rank;
+		Bitboard front = forwardRanksBB(us, rank);
+		Bitboard neighbours = adjacentFilesBB(file);
+
+		// Another of our pawns further up the same file
+		if (ours & fileBB(file) & front) {
+			middlegameScore += middlegame.doubledPawn;
+			endgameScore += endgame.doubledPawn;
+		}
+
+		// No friendly pawns on either side file
+		if (!(ours & neighbours)) {
+			middlegameScore += middlegame.isolatedPawn;
+			endgameScore += endgame.isolatedPawn;
+		}
+		// Neighbours have all advanced past it and the square in front is guarded by an enemy pawn
+		else if (!(ours & neighbours & ~front) && relativeRank < 7 && (theirAttacks & squareBB(square + 8 * us))) {
+			middlegameScore += middlegame.backwardPawn;
+			endgameScore += endgame.backwardPawn;
+		}
+
+		// No enemy pawn can stop or capture it on the way to promotion
+		if (!(theirs & (fileBB(file) | neighbours) & front)) {
+			passed |= squareBB(square);
+			middlegameScore += middlegame.passedPawn[relativeRank];
+			endgameScore += endgame.passedPawn[relativeRank];
+		}
+	}
+}
+
+/*-------------------------------------------------------------------------------------------------------------*\
+* PSTEvaluator::evaluate(const Game&)
+*
+* Parameters: game - Position to evaluate
+* Description: Sums material, piece-square and pawn structure scores for both phases, then interpolates between
+*              them by how much non-pawn material is left on the board
+* Return Value: Score in centipawns, positive when white is better
+\*-------------------------------------------------------------------------------------------------------------*/
+int PSTEvaluator::evaluate(const Game& game) {
+	int middlegameScore = 0;
+	int endgameScore = 0;
+	int phase = 0;
+
+	const Board& board = game.getBoard();
+	Bitboard pawns[2] = { board.pieces(white, pawn), board.pieces(black, pawn) };
+	Bitboard occupied = board.pieces();
+
+	Bitboard pieces = board.pieces();
+	while (pieces) {
+		int i = popLsb(pieces);
+		PieceCode piece = board.pieceOn(i);
+
+		PieceType type = typeOf(piece);
+		Color color = colorOf(piece);
+		int square = (color == white) ? i : i ^ 56;
+		middlegameScore += color * (middlegame.value[type] + middlegame.table[type][square]);
+		endgameScore += color * (endgame.value[type] + endgame.table[type][square]);
+		phase += phaseWeight[type];
+	}
+
+	// Pawn structure, from the pawn hash table when this skeleton has been seen before
+	PawnEntry* entry;
+	if (!pawnTable.probe(game.getPawnKey(), entry)) {
+		int whiteMiddlegame, whiteEndgame, blackMiddlegame, blackEndgame;
+		evaluatePawns(white, pawns[0], pawns[1], whiteMiddlegame, whiteEndgame, entry->passed[0]);
+		evaluatePawns(black, pawns[1], pawns[0], blackMiddlegame, blackEndgame, entry->passed[1]);
+		entry->key = game.getPawnKey();
+		entry->middlegame = whiteMiddlegame - blackMiddlegame;
+		entry->endgame = whiteEndgame - blackEndgame;
+	}
+	middlegameScore += entry->middlegame;
+	endgameScore += entry->endgame;
+
+	// Passed pawns with a piece sitting in front of them only get half their bonus
+	for (int c = 0; c < 2; c++) {
+		Color color = (c == 0) ? white : black;
+		Bitboard passed = entry->passed[c];
+		while (passed) {
+			int square = popLsb(passed);
+			int relativeRank = (color == white) ? square / 8 : 7 - square / 8;
+			if (relativeRank == 7 || !(occupied & squareBB(square + 8 * color))) continue;
+			middlegameScore -= color * middlegame.passedPawn[relativeRank] / 2;
+			endgameScore -= color * endgame.passedPawn[relativeRank] / 2;
+		}
+	}
+
+	// Early promotions can push the phase past its starting value
+	if (phase > MAX_PHASE) phase = MAX_PHASE;
+	return (middlegameScore * phase + endgameScore * (MAX_PHASE - phase)) / MAX_PHASE;
+}
+
+std::shared_ptr<Evaluator> createEvaluator(const std::string& name, const char* nnueFile) {
+	if (name == "nnue") {
+		// The network is shared, so asking for a different file replaces it for every NNUE evaluator
+		if ((NNUE::isLoaded() && NNUE::loadedFile() == nnueFile) || NNUE::load(nnueFile)) return std::make_shared<NNUEEvaluator>();
+		std::cerr << "Failed to load network from " << nnueFile << ", using piece-square tables" << std::endl;
+	}
+	return std::make_shared<PSTEvaluator>();
+}
@@ -0,0 +1,66 @@
+#pragma once
+#include "game.h"
+#include "PawnHashTable.h"
+
+// Evaluations are in centipawns; positive scores favor white
+constexpr int INFINITE_SCORE = 1000000;
+constexpr int DRAW_SCORE = 0;
+// Score for giving mate on the spot. Mates further off score a point less per ply, so the nearest is preferred
+constexpr int MATE_SCORE = 100000;
+// Scores this far from zero or more are mates
+constexpr int MATE_BOUND = MATE_SCORE - 1000;
+
+// Total game phase of the starting material (knight/bishop = 1, rook = 2, queen = 4)
+constexpr int MAX_PHASE = 24;
+
+constexpr const char* DEFAULT_PST_FILE = "res/eval/pst.txt";
+
+// Interface for anything that can statically score a position
+class Evaluator {
+public:
+	virtual ~Evaluator() = default;
+	virtual int evaluate(const Game&) = 0;
+	virtual const char* name() const = 0;
+};
+
+// Evaluation terms for one game phase. Piece values and piece-square tables are indexed by PieceType and by
+// square from white's side, pawn terms by rank from the pawn's own side
+struct PhaseParameters {
+	int value[7] = { 0 };
+	int table[7][64] = { { 0 } };
+	int doubledPawn = 0;
+	int isolatedPawn = 0;
+	int backwardPawn = 0;
+	int passedPawn[8] = { 0 };
+};
+
+// Tapered evaluation: blends middlegame and endgame piece-square tables by the remaining material
+class PSTEvaluator : public Evaluator {
+	PhaseParameters middlegame;
+	PhaseParameters endgame;
+	PawnHashTable pawnTable;
+	bool tablesLoaded = false;
+
+	void evaluatePawns(Color, Bitboard, Bitboard, int&, int&, Bitboard&) const;
+
+public:
+	PSTEvaluator(const char* filepath = DEFAULT_PST_FILE);
+	bool loadTables(const char* filepath);
+	// False if the evaluator fell back to material only because its tables couldn't be read
+	bool hasTables() const { return tablesLoaded; }
+	int evaluate(const Game&) override;
+	const char* name() const override { return "pst"; }
+
+	PawnHashTable& getPawnTable() { return pawnTable; }
+};
+
+// Efficiently updatable neural network evaluation. Needs a network loaded with NNUE::load
+class NNUEEvaluator : public Evaluator {
+public:
+	int evaluate(const Game&) override;
+	const char* name() const override { return "nnue"; }
+};
+
+// Makes the evaluator called 'name' ("pst" or "nnue"). "nnue" loads 'nnueFile' unless it's already the loaded network.
+// Falls back to "pst" if the network can't be loaded
+std::shared_ptr<Evaluator> createEvaluator(const std::string& name, const char* nnueFile = DEFAULT_NNUE_FILE);
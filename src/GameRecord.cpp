@@ -0,0 +1,39 @@
+#include "GameRecord.h"
+#include "notation.h"
+
+// PGN export lines are kept under this length
+constexpr size_t PGN_LINE_LENGTH = 80;
+
+GameRecord::GameRecord(const Game& start) : start(start), written(start) {}
+
+const std::vector<std::string>& GameRecord::getSAN() const {
+	while (sanCache.size() < moves.size()) {
+		const Move& move = moves[sanCache.size()];
+		sanCache.push_back(toSAN(written, move));
+		written.playMove(move);
+	}
+	return sanCache;
+}
+
+std::string GameRecord::toMovetext(const std::string& result) const {
+	const std::vector<std::string>& san = getSAN();
+	std::string movetext, line;
+	auto add = [&](const std::string& token) {
+		if (!line.empty() && line.size() + 1 + token.size() > PGN_LINE_LENGTH) {
+			movetext += line + "\n";
+			line.clear();
+		}
+		line += (line.empty() ? "" : " ") + token;
+	};
+
+	int moveNumber = start.getFullMoveNumber();
+	Color mover = start.whoseTurn();
+	for (size_t i = 0; i < san.size(); i++) {
+		if (mover == white) add(std::to_string(moveNumber) + ". " + san[i]);
+		else add((i == 0) ? std::to_string(moveNumber) + "... " + san[i] : san[i]);
+		if (mover == black) moveNumber++;
+		mover = (Color)-mover;
+	}
+	add(result);
+	return movetext + line;
+}
@@ -0,0 +1,30 @@
+#pragma once
+#include "game.h"
+#include <string>
+
+/*-------------------------------------------------------------------------------------------------------------*\
+* GameRecord
+*
+* Description: The moves of a game in the order they were played, kept as Moves along with the position they
+*              started from. Nothing is written out while the game is played; SAN is made the first time a move is
+*              asked for and kept, so showing the move list every frame only costs the moves added since
+\*-------------------------------------------------------------------------------------------------------------*/
+class GameRecord {
+	Game start;
+	std::vector<Move> moves;
+	// SAN of the first sanCache.size() moves, and the position after them
+	mutable std::vector<std::string> sanCache;
+	mutable Game written;
+
+public:
+	GameRecord() {}
+	GameRecord(const Game& start);
+
+	void record(const Move& move) { moves.push_back(move); }
+	const Game& getStart() const { return start; }
+	const std::vector<Move>& getMoves() const { return moves; }
+	// Every move so far in Standard Algebraic Notation
+	const std::vector<std::string>& getSAN() const;
+	// PGN movetext, numbered from the starting position and ending in 'result', such as "1. e4 e5 2. Nf3 *"
+	std::string toMovetext(const std::string& result = "*") const;
+};
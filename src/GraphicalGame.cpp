@@ -0,0 +1,279 @@
+#include "GraphicalGame.h"
+#include "piece.h"
+#include "Player.h"
+#include "notation.h"
+#include "imgui.h"
+
+constexpr uint16_t BOARD_SIZE = 400;
+
+GraphicalGame::GraphicalGame(unsigned int fbo) : Game(), fbo(fbo) {
+	glGenTextures(1, &boardGraphic);
+	glBindTexture(GL_TEXTURE_2D, boardGraphic);
+	glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, WIN_WIDTH, WIN_HEIGHT, 0, GL_RGB, GL_UNSIGNED_BYTE, NULL);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+	glBindTexture(GL_TEXTURE_2D, 0);
+
+
+	unsigned int render_buffer_object;
+	glGenRenderbuffers(1, &render_buffer_object);
+	glBindRenderbuffer(GL_RENDERBUFFER, render_buffer_object);
+	glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH24_STENCIL8, WIN_WIDTH, WIN_HEIGHT);
+	glBindRenderbuffer(GL_RENDERBUFFER, 0);
+
+	// attaching render buffer 
+	glBindFramebuffer(GL_DRAW_FRAMEBUFFER, fbo);
+	glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, boardGraphic, 0);
+	glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_RENDERBUFFER, render_buffer_object);
+
+	if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+		std::cout << "Frame buffer failed.\n" << std::endl;
+
+	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+
+	colorShader = new Shader("res/shaders/default.vert", "res/shaders/default.frag");
+	pieceShader = new Shader("res/shaders/piece.vert", "res/shaders/piece.frag");
+	// Samplers are program state, so this holds for every frame after
+	pieceShader->activate();
+	pieceShader->setInt("ourTexture", 0);
+	pieceShader->deactivate();
+	renderer = new BoardRenderer();
+	atlas = new PieceAtlas();
+	record = GameRecord(*this);
+}
+
+GraphicalGame::~GraphicalGame() {
+	if (colorShader) delete colorShader;
+	if (pieceShader) delete pieceShader;
+	if (renderer) delete renderer;
+	if (atlas) delete atlas;
+}
+
+// Shows the side to move's piece of 'type' from the atlas as a button. Returns true when it's clicked
+bool GraphicalGame::promotionButton(const char* label, PieceType type) {
+	const AtlasCell& cell = atlas->getCell(makePiece(whoseTurn(), type));
+	return ImGui::ImageButton(label, atlas->getTextureData(), ImVec2(70, 70), ImVec2(cell.u0, cell.v0), ImVec2(cell.u1, cell.v1));
+}
+
+void GraphicalGame::grab(std::shared_ptr<Piece> p) {
+	held = p;
+	boardDirty = true;
+	p->select();
+}
+
+std::shared_ptr<Piece> GraphicalGame::drop() {
+	std::shared_ptr<Piece> returnPiece = held;
+	held->deselect();
+	held = nullptr;
+	boardDirty = true;
+	return returnPiece;
+}
+
+// Moves from both players come through here, so the record holds the whole game
+void GraphicalGame::makePlayerMove(const Move& move) {
+	record.record(move);
+	Game::makePlayerMove(move);
+	boardDirty = true;
+}
+
+// Finishes the pawn move waiting on the player's choice of piece
+void GraphicalGame::promote(PieceType type) {
+	Move move = pendingPromotion;
+	move.promotion = type;
+	pendingPromotion = Move();
+	makePlayerMove(move);
+}
+
+// Makes a drawable piece for every occupied square, keeping the ones that haven't changed
+void GraphicalGame::syncPieces() {
+	for (int i = 0; i < 64; i++) {
+		PieceCode code = board.pieceOn(i);
+		if (!code) pieces[i] = nullptr;
+		else if (!pieces[i] || pieces[i]->getCode() != code) pieces[i] = std::make_shared<Piece>(code, (uint8_t)i);
+	}
+}
+
+
+#define FIX_BOARD_POSITION
+/*-------------------------------------------------------------------------------------------------------------*\
+* GraphicalGame::printBoardImage()
+*
+* Description: Shows the board in its ImGui window. The board is drawn into its framebuffer only when it's dirty
+*              or the held piece has moved with the mouse; every other frame reuses the last image
+\*-------------------------------------------------------------------------------------------------------------*/
+void GraphicalGame::printBoardImage() {
+	ImGui::PushStyleVar(ImGuiStyleVar_WindowPadding, { 0,0 });
+#ifdef FIX_BOARD_POSITION
+	ImGui::SetNextWindowPos(ImVec2(WIN_WIDTH - BOARD_SIZE, 0));
+	ImGui::SetNextWindowSize(ImVec2(BOARD_SIZE, BOARD_SIZE));
+#endif
+	if (ImGui::Begin("Gameview", 0, ImGuiWindowFlags_NoTitleBar | ImGuiWindowFlags_NoScrollbar)) {		//ImGui::SetCursorPos({0, 0})
+		std::vector<PieceInstance> instances;
+		syncPieces();
+		for (int i = 0; i < 64; i++) {
+			std::shared_ptr<Piece> p = pieces[i];
+			if (!p || p->isSelected()) continue;
+			glm::vec3 topLeft((i % 8 - 4) * SQUARE_SIZE, (4 - i / 8) * SQUARE_SIZE, 0.f);
+			instances.push_back({ topLeft, atlas->getCell(p->getCode()), false });
+		}
+		if (held) {
+			ImVec2 mPos = ImGui::GetMousePos();
+			glm::vec3 topLeft;
+			topLeft.x = (mPos.x - (WIN_WIDTH - BOARD_SIZE)) / BOARD_SIZE * 2 - SQUARE_SIZE / 2 - 1;
+			topLeft.y = mPos.y / BOARD_SIZE * 2 + SQUARE_SIZE / 2 - 1;
+			topLeft.z = -.1f;
+			instances.push_back({ topLeft, atlas->getCell(held->getCode()), true });
+		}
+		if (renderer->setPieces(std::move(instances)) || boardDirty) {
+			glBindFramebuffer(GL_DRAW_FRAMEBUFFER, fbo);
+			glEnable(GL_DEPTH_TEST);
+			glClearColor(0.f, 0.f, 0.f, 1.f);
+			glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+			renderer->draw(colorShader, pieceShader, *atlas);
+			glBindFramebuffer(GL_DRAW_FRAMEBUFFER, 0);
+			glDisable(GL_DEPTH_TEST);
+			boardDirty = false;
+		}
+
+		ImGui::Image((void*)(intptr_t)boardGraphic, ImGui::GetContentRegionAvail());
+	}
+	ImGui::PopStyleVar();
+	ImGui::End();
+}
+
+
+void GraphicalGame::printMoveList() {
+	if (ImGui::Begin("Move List")) {
+		if (ImGui::BeginListBox("##", { 200, 300 })) {
+			ImGui::Selectable("Starting Position", false);
+			if (ImGui::BeginTable("Move List", 2, ImGuiTableFlags_Borders, ImVec2(190.f, 0.f))) {
+				int moveNumber = record.getStart().getFullMoveNumber();
+				Color mover = record.getStart().whoseTurn();
+				if (mover == black) ImGui::TableNextColumn();
+				for (const std::string& move : record.getSAN()) {
+					ImGui::TableNextColumn();
+					std::string label = (mover == white) ? std::to_string(moveNumber) + ". " + move : move;
+					ImGui::Selectable(label.c_str(), false);
+					if (mover == black) moveNumber++;
+					mover = (Color)-mover;
+				}
+			}
+			ImGui::EndTable();
+			if (getPlayStatus() == WHITE_WIN) ImGui::Text("1-0");
+			if (getPlayStatus() == BLACK_WIN) ImGui::Text("0-1");
+			if (getPlayStatus() == DRAW)		 ImGui::Text(".5-.5");
+		}
+		ImGui::EndListBox();
+	}
+	ImGui::End();
+}
+
+// Lists how the games in the position database went from here, and the moves they played
+void GraphicalGame::printDatabase() {
+	if (!database) return;
+	if (ImGui::Begin("Database")) {
+		const PositionDBEntry* entry = database->find(*this);
+		if (!entry) ImGui::Text("Position not in the database");
+		else {
+			ImGui::Text("%u games: +%u =%u -%u", entry->games(), entry->whiteWins, entry->draws, entry->blackWins);
+			if (ImGui::BeginTable("Database Moves", 2, ImGuiTableFlags_Borders, ImVec2(190.f, 0.f))) {
+				for (const PositionDBMove& move : database->getMoves(entry)) {
+					ImGui::TableNextColumn();
+					ImGui::Text("%s", toSAN(*this, move.toMove(*this)).c_str());
+					ImGui::TableNextColumn();
+					ImGui::Text("%u", move.count);
+				}
+				ImGui::EndTable();
+			}
+		}
+	}
+	ImGui::End();
+}
+
+/*-------------------------------------------------------------------------------------------------------------*\
+* GraphicalGame::render()
+* 
+* Description: Sets up the ImGUI context of our game, handles user entered moves, and handles pawn promotion
+\*-------------------------------------------------------------------------------------------------------------*/
+void GraphicalGame::render() {
+	printBoardImage();
+	printMoveList();
+	printDatabase();
+
+	ImGui::Begin("Gameview");
+	ImGuiIO& io = ImGui::GetIO();
+
+	if (getPlayStatus() != PLAYING) {
+		ImGui::End();
+		return;
+	}
+	
+	(whoseTurn() == white) ? whitePlayer->itsMyTurn() : blackPlayer->itsMyTurn();
+
+	if (isWaitingOnPromotion()) {
+		PieceType promotionPiece = open;
+		ImGui::Begin("Promotion Selection", 0, ImGuiWindowFlags_NoTitleBar);
+
+		if (promotionButton("Queen", queen)) {
+			promotionPiece = queen;
+		}
+		ImGui::SameLine();
+		if (promotionButton("Rook", rook)) {
+			promotionPiece = rook;
+		}
+
+		if (promotionButton("Knight", knight)) {
+			promotionPiece = knight;
+		}
+		ImGui::SameLine();
+		if (promotionButton("Bishop", bishop)) {
+			promotionPiece = bishop;
+		}
+
+		if (promotionPiece != open) promote(promotionPiece);
+
+		ImGui::End();
+	}
+
+	else if (ImGui::IsMouseDown(0) && ImGui::IsWindowHovered() && !isHolding()) {
+		ImVec2 wPos  = ImGui::GetWindowPos();
+		ImVec2 wSize = ImGui::GetWindowSize();
+		ImVec2 mPos  = { io.MousePos.x - wPos.x, io.MousePos.y - wPos.y };
+		char file    = (char)(mPos.x / (wSize.x / 8));
+		char rank    = (char)(8 - mPos.y / (wSize.y / 8));
+		syncPieces();
+		std::shared_ptr<Piece> p     = pieces[rank * 8 + file];
+		if (p && p->getColor() == whoseTurn() && !isWaitingOnPromotion()) {
+			grab(p);
+		}
+	} 
+
+	else if (ImGui::IsMouseReleased(0) && isHolding()) {
+		ImVec2 wPos			= ImGui::GetWindowPos();
+		ImVec2 wSize		= ImGui::GetWindowSize();
+		ImVec2 mPos			= { io.MousePos.x - wPos.x, io.MousePos.y - wPos.y };
+		char file			= (char)(mPos.x / (wSize.x / 8));
+		char rank			= (char)(8 - mPos.y / (wSize.y / 8));
+		std::shared_ptr<Piece> movedPiece	= drop();
+		if (movedPiece) {
+			std::vector<Move> legals;
+			getLegalPieceMoves(&legals, movedPiece->getPosition());
+			uint8_t target = (uint8_t)(rank * 8 + file);
+			for (const Move& legal : legals) {
+				if (legal.target != target) continue;
+				// The promotion piece is picked after the drop, so the move waits until then
+				if (legal.promotion != open) pendingPromotion = legal;
+				else makePlayerMove(legal);
+				break;
+			}
+		}
+	}
+	ImGui::End();
+}
+
+void GraphicalGame::addPlayer(Player* player, Color color) {
+	if (color == white) whitePlayer = player;
+	else blackPlayer = player;
+}
+
+
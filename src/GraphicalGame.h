@@ -0,0 +1,59 @@
+#pragma once
+#include "game.h"
+#include "GameRecord.h"
+#include "PositionDB.h"
+#include "graphics.h"
+#include "shader.h"
+#include "BoardRenderer.h"
+#include "PieceAtlas.h"
+
+class Player;
+class Piece;
+
+// A Game drawn with OpenGL into an ImGui window, taking moves from two Players
+class GraphicalGame : public Game {
+	unsigned int fbo = 0;
+	Shader* colorShader = nullptr;
+	Shader* pieceShader = nullptr;
+	BoardRenderer* renderer = nullptr;
+	// Every piece image, for the board and the promotion buttons alike
+	PieceAtlas* atlas = nullptr;
+
+	GLuint boardGraphic = 0;
+	// Set when boardGraphic no longer shows the game: a move was played or a piece was picked up or put down
+	bool boardDirty = true;
+	// Drawable pieces matching the board, rebuilt where the board has changed
+	std::shared_ptr<Piece> pieces[64];
+	std::shared_ptr<Piece> held = nullptr;
+	// Moves played so far, written out as SAN for the move list
+	GameRecord record;
+	// A pawn move to the last rank waiting on the player to pick the piece
+	Move pendingPromotion;
+	// Games through the current position are listed from here when set
+	const PositionDB* database = nullptr;
+
+	Player* whitePlayer = 0;
+	Player* blackPlayer = 0;
+
+
+	bool isHolding() { return (held != nullptr); }
+	bool isWaitingOnPromotion() const { return pendingPromotion.piece != NO_PIECE; }
+	void syncPieces();
+	void printBoardImage();
+	void printMoveList();
+	void printDatabase();
+	void grab(std::shared_ptr<Piece>);
+	std::shared_ptr<Piece> drop();
+	bool promotionButton(const char* label, PieceType);
+public:
+	GraphicalGame(unsigned int);
+	~GraphicalGame();
+	void render();
+	// True while the game needs frames without waiting for input: the board is out of date or a piece is being
+	// dragged
+	bool needsFrame() const { return boardDirty || held != nullptr; }
+	void addPlayer(Player*, Color);
+	void setDatabase(const PositionDB* db) { database = db; }
+	void makePlayerMove(const Move&) override;
+	void promote(PieceType);
+};
@@ -0,0 +1,110 @@
+#include "MiniMaxTree.h"
+#include <algorithm>
+#include <cassert>
+#include <chrono>
+
+/*-------------------------------------------------------------------------------------------------------------*\
+* MiniMaxTree::deepen(MMTNode*)
+*
+* Parameters: node - Node to search below
+* Description: Follows the best moves down from 'node' to a leaf, expands it, and passes the new evaluations back
+*              up through every ancestor to the root
+\*-------------------------------------------------------------------------------------------------------------*/
+void MiniMaxTree::deepen(MMTNode* node) {
+	MMTNode* working = node;
+	MMTNode* next = 0;
+	while (!working->isLeaf()) {
+		next = working->children[working->bestMove];
+		if (!next) break;
+		working = next;
+	}
+	working->expand();
+	while (working) {
+		working->evaluate();
+		working = working->parent;
+	}
+}
+
+// Root moves ordered best first for the side to move, with the root's own best move always in front
+std::vector<std::pair<Move, MMTNode*>> MiniMaxTree::rankedRootMoves() const {
+	std::vector<std::pair<Move, MMTNode*>> ranked;
+	for (auto& child : root->children) {
+		if (child.second == 0) continue;
+		if (child.first == root->bestMove) ranked.insert(ranked.begin(), child);
+		else ranked.push_back(child);
+	}
+	std::stable_sort(ranked.begin(), ranked.end(), [this](const std::pair<Move, MMTNode*>& a, const std::pair<Move, MMTNode*>& b) {
+		return root->prefers(a.second->eval, b.second->eval);
+	});
+	return ranked;
+}
+
+/*-------------------------------------------------------------------------------------------------------------*\
+* MiniMaxTree::search(uint64_t, PVCallback)
+*
+* Parameters: searchLimit - Number of iterations to run, unless stop() is called first
+*             onIteration - Optional callback, given the current lines after each iteration
+* Description: Grows the tree best-first. Each iteration deepens the principal line of every one of the top
+*              'multiPV' root moves, so the runner-up lines get real scores instead of their first static eval.
+*              With multiPV at 1 this is the plain search: one expansion along the best line per iteration
+\*-------------------------------------------------------------------------------------------------------------*/
+void MiniMaxTree::search(uint64_t searchLimit, PVCallback onIteration) {
+	assert(root != 0);
+
+	// The pawn hash is the evaluator's, so count the lookups made during this search only
+	PSTEvaluator* pst = dynamic_cast<PSTEvaluator*>(root->evaluator);
+
+	stopRequested = false;
+	for (uint64_t i = 0; i < searchLimit && !stopRequested; i++) {
+		auto start = std::chrono::steady_clock::now();
+		uint64_t pawnProbes = (pst) ? pst->getPawnTable().getProbes() : 0;
+		uint64_t pawnHits = (pst) ? pst->getPawnTable().getHits() : 0;
+
+		if (multiPV == 1 || root->isLeaf()) deepen(root);
+		else {
+			// Rank once up front so a line that drops mid-iteration doesn't let another be deepened twice
+			std::vector<std::pair<Move, MMTNode*>> ranked = rankedRootMoves();
+			size_t lines = std::min(ranked.size(), (size_t)multiPV);
+			for (size_t line = 0; line < lines; line++) {
+				deepen(ranked[line].second);
+			}
+		}
+
+		stats.iterations++;
+		if (pst) {
+			stats.pawnHashProbes += pst->getPawnTable().getProbes() - pawnProbes;
+			stats.pawnHashHits += pst->getPawnTable().getHits() - pawnHits;
+		}
+		std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+		stats.seconds += elapsed.count();
+
+		if (onIteration) onIteration((int)i + 1, getLines());
+	}
+}
+
+/*-------------------------------------------------------------------------------------------------------------*\
+* MiniMaxTree::getLines()
+*
+* Description: Builds the current analysis from the tree, one line for each of the top 'multiPV' root moves
+* Return Value: Lines ordered best first for the side to move at the root. Empty before the first iteration
+\*-------------------------------------------------------------------------------------------------------------*/
+std::vector<PVLine> MiniMaxTree::getLines() const {
+	std::vector<PVLine> lines;
+	std::vector<std::pair<Move, MMTNode*>> ranked = rankedRootMoves();
+	for (size_t i = 0; i < ranked.size() && i < (size_t)multiPV; i++) {
+		PVLine line;
+		line.move = ranked[i].first;
+		line.score = ranked[i].second->eval;
+		line.pv.push_back(ranked[i].first);
+
+		MMTNode* node = ranked[i].second;
+		while (!node->isLeaf()) {
+			auto next = node->children.find(node->bestMove);
+			if (next == node->children.end() || !next->second) break;
+			line.pv.push_back(next->first);
+			node = next->second;
+		}
+		lines.push_back(line);
+	}
+	return lines;
+}
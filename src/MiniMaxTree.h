@@ -0,0 +1,143 @@
+#pragma once
+#include "game.h"
+#include "Evaluator.h"
+#include "SearchStats.h"
+#include <unordered_map>
+#include <functional>
+#include <atomic>
+
+struct MMTNode {
+	std::shared_ptr<Game> nodeState;
+	MMTNode* parent;
+	std::unordered_map<Move, MMTNode*, MoveHasher> children;
+	Move bestMove;
+	Color whoseMove;
+	Evaluator* evaluator;
+	SearchStats* stats = 0;
+	int eval;
+	uint16_t ply = 0;
+	// Expanded and found to have no legal moves: checkmate or stalemate
+	bool noLegalMoves = false;
+
+	MMTNode(std::shared_ptr<Game> nodeState, MMTNode* parent, Color whoseMove, Evaluator* evaluator) {
+		this->nodeState = std::make_shared<Game>(Game(nodeState));
+		this->parent = parent;
+		this->whoseMove = whoseMove;
+		this->evaluator = evaluator;
+		eval = 0;
+
+		bestMove = Move();
+	}
+
+	~MMTNode() {
+		for (auto& child : children) {
+			delete child.second;
+			child.second = 0;
+		}
+		children.clear();
+	}
+
+	bool isLeaf() {
+		return children.size() == 0;
+	}
+
+	// Is 'a' a better score than 'b' for the side to move here
+	bool prefers(int a, int b) const {
+		return (whoseMove == white) ? a > b : a < b;
+	}
+
+	void evaluate() {
+		if (isLeaf()) {
+			// A position repeated inside the tree is scored as a draw; playing on would only cycle
+			if (isRepetition()) eval = DRAW_SCORE;
+			else if (noLegalMoves) {
+				if (!nodeState->isInCheck(whoseMove)) eval = DRAW_SCORE;
+				else eval = (whoseMove == white) ? -MATE_SCORE + ply : MATE_SCORE - ply;
+			}
+			else {
+				eval = evaluator->evaluate(*nodeState);
+				if (stats) stats->evaluations++;
+			}
+		}
+		else {
+			int bestChildEval = (whoseMove == white) ? -INFINITE_SCORE : INFINITE_SCORE;
+			for (auto& child : children) {
+				if (child.second == 0) continue;
+				if (prefers(child.second->eval, bestChildEval)) {
+					bestMove = child.first;
+					bestChildEval = child.second->eval;
+				}
+			}
+
+			eval = bestChildEval;
+		}
+	}
+
+	// The root is searched even when the game has been there before
+	bool isRepetition() {
+		return parent && nodeState->isRepetition();
+	}
+
+	void expand() {
+		std::vector<Move> legalMoves;
+		if (!isRepetition()) nodeState->getAllLegalMoves(&legalMoves, whoseMove);
+		Color nextPlayer = (whoseMove == white) ? black : white;
+		// The move generation already done tells mate and stalemate apart from quiet positions for free
+		noLegalMoves = legalMoves.empty() && !isRepetition();
+		if (stats) {
+			stats->expansions++;
+			stats->nodes += legalMoves.size();
+			if (legalMoves.empty()) stats->terminalNodes++;
+			if (ply + 1u > stats->maxDepth) stats->maxDepth = ply + 1u;
+		}
+		for (Move childMove : legalMoves) {
+			MMTNode* child = new MMTNode(nodeState, this, nextPlayer, evaluator);
+			child->stats = stats;
+			child->ply = ply + 1;
+			child->nodeState->playMove(childMove);
+			// Checks are rare enough to look for mate right away, so a mate scores before its line is ever deepened
+			child->noLegalMoves = child->nodeState->isInCheck(nextPlayer) && !child->nodeState->hasLegalMove(nextPlayer);
+			child->evaluate();
+			children[childMove] = child;
+		}
+	}
+};
+
+// One line of analysis from the root: the first move, its score (centipawns, positive favors white) and the
+// expected continuation starting with that move
+struct PVLine {
+	Move move;
+	int score = 0;
+	std::vector<Move> pv;
+};
+
+// Called after every search iteration with the current lines, best first
+typedef std::function<void(int iteration, const std::vector<PVLine>&)> PVCallback;
+
+class MiniMaxTree {
+	MMTNode* root = 0;
+	int multiPV = 1;
+	SearchStats stats;
+	std::atomic<bool> stopRequested{ false };
+
+	void deepen(MMTNode*);
+	std::vector<std::pair<Move, MMTNode*>> rankedRootMoves() const;
+
+public:
+	MiniMaxTree(MMTNode* root) {
+		this->root = root;
+		root->stats = &stats;
+	}
+
+	// Number of root moves to keep searching and reporting. 1 is a normal search for the best move
+	void setMultiPV(int lines) { multiPV = (lines < 1) ? 1 : lines; }
+	int getMultiPV() const { return multiPV; }
+
+	void search(uint64_t searchLimit, PVCallback onIteration = nullptr);
+	// Ends a running search after its current iteration. Safe to call from another thread or from the callback
+	void stop() { stopRequested = true; }
+	std::vector<PVLine> getLines() const;
+
+	// Totals since the tree was made. Up to date after every iteration, so a PVCallback can read them too
+	const SearchStats& getStats() const { return stats; }
+};
@@ -0,0 +1,19 @@
+#pragma once
+#include <stdint.h>
+
+// Compact fixed-size copy of a position for storing and passing around in bulk. Pieces are 4-bit codes
+// (PieceType, plus 8 for black) listed in square order for each set bit of 'occupancy', two to a byte with the
+// lower square in the low nibble. Everything is bytes so the layout is the same on every compiler
+struct PackedPosition {
+	uint8_t occupancy[8];	// One bit per square, a1 is bit 0 of the first byte
+	uint8_t pieces[16];
+	uint8_t flags;			// Castling rights in the low 4 bits (as in Game's status), black to move in bit 4
+	int8_t enPassant;		// Square a pawn can capture onto en passant, or -1
+	uint8_t fiftyMoveRule;	// Plies since the last capture or pawn move
+	uint8_t reserved;
+};
+static_assert(sizeof(PackedPosition) == 28, "PackedPosition should stay 28 bytes");
+
+constexpr uint8_t PACKED_CASTLING_MASK	= 0x0F;
+constexpr uint8_t PACKED_BLACK_TO_MOVE	= 0x10;
+constexpr uint8_t PACKED_BLACK_PIECE	= 0x08;
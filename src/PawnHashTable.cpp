@@ -0,0 +1,37 @@
+#include "PawnHashTable.h"
+#include <algorithm>
+
+PawnHashTable::PawnHashTable(size_t numEntries) {
+	resize(numEntries);
+}
+
+// Sets the table to the largest power of two that fits 'numEntries' and empties it
+void PawnHashTable::resize(size_t numEntries) {
+	size_t size = 1;
+	while (size * 2 <= numEntries) size *= 2;
+	entries.assign(size, PawnEntry());
+	resetCounters();
+}
+
+// An empty entry has key 0 and scores 0, which is also the correct answer for a board without pawns
+void PawnHashTable::clear() {
+	std::fill(entries.begin(), entries.end(), PawnEntry());
+}
+
+/*-------------------------------------------------------------------------------------------------------------*\
+* PawnHashTable::probe(uint64_t, PawnEntry*&)
+*
+* Parameters: key - Pawn hash of the position
+*             entry - Set to the slot for 'key'
+* Description: Looks up a pawn structure. On a miss the slot is handed back for the caller to fill in
+* Return Value: True if the slot already holds 'key'
+\*-------------------------------------------------------------------------------------------------------------*/
+bool PawnHashTable::probe(uint64_t key, PawnEntry*& entry) {
+	probes++;
+	entry = &entries[key & (entries.size() - 1)];
+	if (entry->key == key) {
+		hits++;
+		return true;
+	}
+	return false;
+}
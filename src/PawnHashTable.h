@@ -0,0 +1,30 @@
+#pragma once
+#include "bitboard.h"
+#include <cstddef>
+#include <vector>
+
+// Cached pawn structure evaluation for one pawn configuration
+struct PawnEntry {
+	uint64_t key = 0;
+	int middlegame = 0;
+	int endgame = 0;
+	Bitboard passed[2] = { 0, 0 };	// indexed white, black
+};
+
+// Hash table of pawn structure evaluations keyed by Game::getPawnKey(). Pawns move rarely, so most probes hit
+class PawnHashTable {
+	std::vector<PawnEntry> entries;
+	uint64_t probes = 0;
+	uint64_t hits = 0;
+
+public:
+	PawnHashTable(size_t numEntries = 1 << 14);
+	void resize(size_t numEntries);
+	void clear();
+	bool probe(uint64_t key, PawnEntry*& entry);
+
+	uint64_t getProbes() const { return probes; }
+	uint64_t getHits() const { return hits; }
+	double hitRate() const { return (probes) ? (double)hits / probes : 0.0; }
+	void resetCounters() { probes = hits = 0; }
+};
@@ -0,0 +1,68 @@
+#include "PieceAtlas.h"
+#include <cctype>
+#include <cstring>
+#include <string>
+
+// Room for the largest piece image, and transparent texels around each one so mipmaps don't bleed between cells
+constexpr int ATLAS_CELL_SIZE = 128;
+constexpr int ATLAS_PADDING = 4;
+constexpr int ATLAS_STRIDE = ATLAS_CELL_SIZE + 2 * ATLAS_PADDING;
+// Pawn to king across, white above black
+constexpr int ATLAS_WIDTH = 6 * ATLAS_STRIDE;
+constexpr int ATLAS_HEIGHT = 2 * ATLAS_STRIDE;
+
+/*-------------------------------------------------------------------------------------------------------------*\
+* PieceAtlas::PieceAtlas()
+*
+* Description: Reads the twelve piece images into one RGBA buffer, uploads it and builds its mipmaps, once.
+*              A missing or oversized image leaves its cell transparent
+\*-------------------------------------------------------------------------------------------------------------*/
+PieceAtlas::PieceAtlas() {
+	std::vector<unsigned char> pixels((size_t)ATLAS_WIDTH * ATLAS_HEIGHT * 4, 0);
+	for (Color color : { white, black }) {
+		for (int type = pawn; type <= king; type++) {
+			PieceCode code = makePiece(color, (PieceType)type);
+			std::string path = "res/textures/";
+			path.append((color == black) ? "black_" : "white_");
+			path += (char)toupper(pieceSymbol(code));
+			path.append(".png");
+
+			int width, height, nChannels;
+			// Always four channels, whatever the file holds
+			unsigned char* data = stbi_load(path.c_str(), &width, &height, &nChannels, 4);
+			if (!data || width > ATLAS_CELL_SIZE || height > ATLAS_CELL_SIZE) {
+				std::cerr << "Failed to load piece texture " << path << std::endl;
+				stbi_image_free(data);
+				continue;
+			}
+
+			int left = (type - pawn) * ATLAS_STRIDE + ATLAS_PADDING;
+			int top = colorIndex(color) * ATLAS_STRIDE + ATLAS_PADDING;
+			for (int row = 0; row < height; row++) {
+				memcpy(&pixels[((size_t)(top + row) * ATLAS_WIDTH + left) * 4], data + (size_t)row * width * 4, (size_t)width * 4);
+			}
+			stbi_image_free(data);
+
+			AtlasCell& cell = cells[colorIndex(color)][type];
+			cell.u0 = (float)left / ATLAS_WIDTH;
+			cell.v0 = (float)top / ATLAS_HEIGHT;
+			cell.u1 = (float)(left + width) / ATLAS_WIDTH;
+			cell.v1 = (float)(top + height) / ATLAS_HEIGHT;
+		}
+	}
+
+	glGenTextures(1, &texture);
+	glBindTexture(GL_TEXTURE_2D, texture);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+	glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, ATLAS_WIDTH, ATLAS_HEIGHT, 0, GL_RGBA, GL_UNSIGNED_BYTE, pixels.data());
+	glGenerateMipmap(GL_TEXTURE_2D);
+	glBindTexture(GL_TEXTURE_2D, 0);
+}
+
+PieceAtlas::~PieceAtlas() {
+	glDeleteTextures(1, &texture);
+}
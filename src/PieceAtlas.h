@@ -0,0 +1,34 @@
+#pragma once
+#include "graphics.h"
+#include "board.h"
+
+// Where one image sits in an atlas, in texture coordinates: its first row at v0 and its last at v1
+struct AtlasCell {
+	float u0 = 0.f;
+	float v0 = 0.f;
+	float u1 = 0.f;
+	float v1 = 0.f;
+};
+
+/*-------------------------------------------------------------------------------------------------------------*\
+* PieceAtlas
+*
+* Description: Every piece image packed into one texture, loaded from res/textures once and shared by everything
+*              that draws a piece: the board and the promotion buttons alike. Pieces find their image by code, so
+*              they hold no GL handles of their own. Needs a current opengl context to construct
+\*-------------------------------------------------------------------------------------------------------------*/
+class PieceAtlas {
+	GLuint texture = 0;
+	AtlasCell cells[2][7];		// By color index and piece type
+
+public:
+	PieceAtlas();
+	PieceAtlas(const PieceAtlas&) = delete;
+	PieceAtlas& operator=(const PieceAtlas&) = delete;
+	~PieceAtlas();
+
+	GLuint getTexture() const { return texture; }
+	// For ImGui::Image and ImGui::ImageButton
+	void* getTextureData() const { return (void*)(intptr_t)texture; }
+	const AtlasCell& getCell(PieceCode code) const { return cells[colorIndex(colorOf(code))][typeOf(code)]; }
+};
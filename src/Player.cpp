@@ -1,3 +1,7 @@
 #include "Player.h"
 
-Player::Player(std::shared_ptr<Game> game, Color color) :activeGame(game), playerColor(color) {}
\ No newline at end of file
+Player::Player(std::shared_ptr<Game> game, Color color) :activeGame(game), playerColor(color) {}
+
+AIPlayer::AIPlayer(std::shared_ptr<Game> game, Color color, std::shared_ptr<Evaluator> evaluator) : Player(game, color), evaluator(evaluator) {
+	if (!this->evaluator) this->evaluator = createEvaluator("pst");
+}
@@ -1,5 +1,6 @@
 #pragma once
 #include "game.h"
+#include "Evaluator.h"
 
 class Player {
 protected:
@@ -17,7 +18,8 @@ public:
 };
 
 class AIPlayer : public Player {
+	std::shared_ptr<Evaluator> evaluator;
 public:
-	using Player::Player;
+	AIPlayer(std::shared_ptr<Game>, Color, std::shared_ptr<Evaluator> = nullptr);
 	void itsMyTurn() override;
 };
\ No newline at end of file
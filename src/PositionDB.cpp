@@ -0,0 +1,505 @@
+#include "PositionDB.h"
+#include "notation.h"
+#include "pgn.h"
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <memory>
+#include <queue>
+#include <random>
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+// Marks the final position of a game in the builder: it counts towards the results but has no move
+constexpr uint16_t NO_DB_MOVE = 0;
+
+static size_t alignTo8(size_t bytes) {
+	return (bytes + 7) & ~(size_t)7;
+}
+
+static size_t indexOffset() {
+	return alignTo8(sizeof(PositionDBHeader));
+}
+
+static size_t entriesOffset(uint32_t indexBits) {
+	return alignTo8(indexOffset() + (((size_t)1 << indexBits) + 1) * sizeof(uint32_t));
+}
+
+static uint32_t bucketOf(uint64_t key, uint32_t indexBits) {
+	return (indexBits) ? (uint32_t)(key >> (64 - indexBits)) : 0;
+}
+
+PositionDB::~PositionDB() {
+	close();
+}
+
+/*-------------------------------------------------------------------------------------------------------------*\
+* PositionDB::open(const std::string&)
+*
+* Parameters: path - Database written by buildPositionDB()
+* Description: Maps the whole file read-only and checks that its sections fit in it. Pages are read in by the
+*              operating system as lookups touch them
+* Return Value: False if the file can't be mapped or isn't a database this build can read
+\*-------------------------------------------------------------------------------------------------------------*/
+bool PositionDB::open(const std::string& path) {
+	close();
+#ifdef _WIN32
+	HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_RANDOM_ACCESS, nullptr);
+	if (file == INVALID_HANDLE_VALUE) {
+		std::cerr << "Failed to open position database " << path << std::endl;
+		return false;
+	}
+	LARGE_INTEGER fileSize;
+	GetFileSizeEx(file, &fileSize);
+	HANDLE mapping = (fileSize.QuadPart > 0) ? CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr) : nullptr;
+	void* view = (mapping) ? MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0) : nullptr;
+	// The view keeps the file mapped on its own
+	if (mapping) CloseHandle(mapping);
+	CloseHandle(file);
+	size = (size_t)fileSize.QuadPart;
+#else
+	// Opened through stdio since fcntl.h's open() would clash with PieceType's 'open'
+	std::FILE* file = std::fopen(path.c_str(), "rb");
+	if (!file) {
+		std::cerr << "Failed to open position database " << path << std::endl;
+		return false;
+	}
+	struct stat status;
+	void* view = nullptr;
+	if (fstat(fileno(file), &status) == 0 && status.st_size > 0) {
+		view = mmap(nullptr, status.st_size, PROT_READ, MAP_SHARED, fileno(file), 0);
+		if (view == MAP_FAILED) view = nullptr;
+		else madvise(view, status.st_size, MADV_RANDOM);
+	}
+	std::fclose(file);
+	size = (view) ? (size_t)status.st_size : 0;
+#endif
+	if (!view) {
+		std::cerr << "Failed to map position database " << path << std::endl;
+		return false;
+	}
+	data = (const uint8_t*)view;
+
+	header = (const PositionDBHeader*)data;
+	bool valid = size >= sizeof(PositionDBHeader) && memcmp(header->magic, POSITION_DB_MAGIC, sizeof(POSITION_DB_MAGIC)) == 0
+		&& header->version == POSITION_DB_VERSION && header->indexBits <= POSITION_DB_MAX_INDEX_BITS;
+	size_t movesOffset = 0;
+	if (valid) {
+		movesOffset = entriesOffset(header->indexBits) + (header->positions + 1) * sizeof(PositionDBEntry);
+		valid = movesOffset + header->moves * sizeof(PositionDBMove) <= size;
+	}
+	if (!valid) {
+		std::cerr << path << " is not a position database, or was written by a different version" << std::endl;
+		close();
+		return false;
+	}
+
+	index = (const uint32_t*)(data + indexOffset());
+	entries = (const PositionDBEntry*)(data + entriesOffset(header->indexBits));
+	moves = (const PositionDBMove*)(data + movesOffset);
+	return true;
+}
+
+void PositionDB::close() {
+	if (data) {
+#ifdef _WIN32
+		UnmapViewOfFile(data);
+#else
+		munmap((void*)data, size);
+#endif
+	}
+	data = nullptr;
+	size = 0;
+	header = nullptr;
+	index = nullptr;
+	entries = nullptr;
+	moves = nullptr;
+}
+
+const PositionDBEntry* PositionDB::find(uint64_t key) const {
+	if (!data) return nullptr;
+	uint32_t bucket = bucketOf(key, header->indexBits);
+	const PositionDBEntry* first = entries + index[bucket];
+	const PositionDBEntry* last = entries + index[bucket + 1];
+	const PositionDBEntry* found = std::lower_bound(first, last, key,
+		[](const PositionDBEntry& entry, uint64_t key) { return entry.key < key; });
+	return (found != last && found->key == key) ? found : nullptr;
+}
+
+PositionDBMoves PositionDB::getMoves(const PositionDBEntry* entry) const {
+	PositionDBMoves result;
+	if (!entry) return result;
+	result.first = moves + entry->firstMove;
+	result.last = moves + (entry + 1)->firstMove;
+	return result;
+}
+
+
+// One position reached in one game, and the move played from it
+struct PositionSample {
+	uint64_t key;
+	uint16_t move;
+	int8_t result;
+
+	bool operator<(const PositionSample& other) const {
+		return (key != other.key) ? key < other.key : move < other.move;
+	}
+};
+
+// How often one move was played from one position, and how those games ended, summed over a run of samples
+struct PositionCount {
+	uint64_t key;
+	uint16_t move;
+	uint16_t reserved;
+	uint32_t results[3];		// White wins, draws, black wins
+
+	uint32_t games() const { return results[0] + results[1] + results[2]; }
+};
+
+// Counts read back from a run file at a time while merging
+constexpr size_t RUN_READ_BLOCK = 4096;
+
+// A temporary file, deleted when closed
+struct TempFile {
+	std::FILE* file = nullptr;
+
+	TempFile() {}
+	TempFile(const TempFile&) = delete;
+	TempFile& operator=(const TempFile&) = delete;
+	~TempFile() { if (file) std::fclose(file); }
+
+	bool open() {
+		file = std::tmpfile();
+		return file != nullptr;
+	}
+};
+
+// One sorted run of counts: spilled to a temporary file, or held whole in memory when it's the only run
+struct CountRun {
+	TempFile spill;
+	std::vector<PositionCount> block;
+	size_t next = 0;
+
+	// The run's next count, or nullptr at its end
+	const PositionCount* peek() {
+		if (next == block.size()) {
+			if (!spill.file) return nullptr;
+			block.resize(RUN_READ_BLOCK);
+			block.resize(std::fread(block.data(), sizeof(PositionCount), RUN_READ_BLOCK, spill.file));
+			next = 0;
+			if (block.empty()) return nullptr;
+		}
+		return &block[next];
+	}
+};
+
+static uint16_t packMove(const Move& move) {
+	return move.source | (move.target << 6) | (move.promotion << 12);
+}
+
+// Writes 'count' items, returning false if the disk didn't take them all
+template<typename T>
+static bool writeAll(std::FILE* file, const T* items, size_t count) {
+	return std::fwrite(items, sizeof(T), count, file) == count;
+}
+
+// Appends everything in 'from', from its start
+static bool copyAll(std::FILE* from, std::FILE* to) {
+	std::rewind(from);
+	std::vector<char> buffer(1 << 20);
+	size_t got;
+	while ((got = std::fread(buffer.data(), 1, buffer.size(), from)) > 0) {
+		if (!writeAll(to, buffer.data(), got)) return false;
+	}
+	return !std::ferror(from);
+}
+
+// Sorts the samples and sums equal positions and moves into 'counts', emptying 'samples'
+static void countSamples(std::vector<PositionSample>& samples, std::vector<PositionCount>& counts) {
+	std::sort(samples.begin(), samples.end());
+	counts.clear();
+	for (const PositionSample& sample : samples) {
+		if (counts.empty() || counts.back().key != sample.key || counts.back().move != sample.move) {
+			counts.push_back({ sample.key, sample.move, 0, { 0, 0, 0 } });
+		}
+		counts.back().results[(sample.result > 0) ? 0 : (sample.result == 0) ? 1 : 2]++;
+	}
+	samples.clear();
+}
+
+/*-------------------------------------------------------------------------------------------------------------*\
+* buildPositionDB(const std::vector<std::string>&, const std::string&, const PositionDBOptions&, std::ostream&)
+*
+* Parameters: pgnFiles - Games to index
+*             outFile - Database to write, replacing whatever is there
+*             options - Which positions to keep, and the memory to sort in
+*             os - Where progress and totals are printed
+* Description: An external sort, so archives far larger than memory can be indexed. Replaying the games collects
+*              a sample per position reached; whenever options.memoryMB of them pile up they're sorted, summed by
+*              position and move, and spilled to a temporary file as one run. The runs are then merged by key, so
+*              each position's counts arrive together: their results are summed into one entry and equal moves
+*              into one move count. Entries and moves are streamed to temporary files too, and the index is
+*              filled in from the entries' keys before everything is copied into place
+* Return Value: False if a PGN file couldn't be read or the database couldn't be written
+\*-------------------------------------------------------------------------------------------------------------*/
+bool buildPositionDB(const std::vector<std::string>& pgnFiles, const std::string& outFile, const PositionDBOptions& options, std::ostream& os) {
+	auto start = std::chrono::steady_clock::now();
+	size_t runSamples = std::max<size_t>(1, options.memoryMB * (1 << 20) / (sizeof(PositionSample) + sizeof(PositionCount)));
+	std::vector<PositionSample> samples;
+	std::vector<PositionCount> counts;
+	std::vector<std::unique_ptr<CountRun>> runs;
+	uint64_t games = 0, skipped = 0;
+	bool spillFailed = false;
+
+	// Sorts what's been collected into a run. The runs before the last one always go to disk
+	auto spill = [&]() {
+		countSamples(samples, counts);
+		std::unique_ptr<CountRun> run = std::make_unique<CountRun>();
+		if (!run->spill.open() || !writeAll(run->spill.file, counts.data(), counts.size()) || std::fflush(run->spill.file) != 0) {
+			spillFailed = true;
+			return;
+		}
+		std::rewind(run->spill.file);
+		runs.push_back(std::move(run));
+	};
+
+	PGNReader reader;
+	Game game;
+	for (const std::string& pgnFile : pgnFiles) {
+		bool read = reader.readFile(pgnFile.c_str(), [&](const PGNGame& pgn) {
+			int8_t result = (pgn.result == "1-0") ? 1 : (pgn.result == "0-1") ? -1 : (pgn.result == "1/2-1/2") ? 0 : 2;
+			if (pgn.error || result == 2) {
+				skipped++;
+				return true;
+			}
+
+			game = Game();
+			std::string_view fen = pgn.tag("FEN");
+			if (!fen.empty()) game.fromFEN(std::string(fen));
+			size_t plies = (options.maxPly > 0) ? std::min(pgn.moves.size(), (size_t)options.maxPly) : pgn.moves.size();
+			for (size_t i = 0; i < plies; i++) {
+				samples.push_back({ positionDBKey(game), packMove(pgn.moves[i]), result });
+				game.playMove(pgn.moves[i]);
+			}
+			samples.push_back({ positionDBKey(game), NO_DB_MOVE, result });
+			games++;
+			if (samples.size() >= runSamples) spill();
+			return !spillFailed;
+		});
+		if (spillFailed) {
+			std::cerr << "Failed to write a temporary file while sorting positions" << std::endl;
+			return false;
+		}
+		if (!read) return false;
+	}
+
+	// A single run never needs to touch the disk
+	if (runs.empty()) {
+		std::unique_ptr<CountRun> run = std::make_unique<CountRun>();
+		countSamples(samples, run->block);
+		runs.push_back(std::move(run));
+	}
+	else if (!samples.empty()) {
+		spill();
+		if (spillFailed) {
+			std::cerr << "Failed to write a temporary file while sorting positions" << std::endl;
+			return false;
+		}
+	}
+	std::vector<PositionSample>().swap(samples);
+	std::vector<PositionCount>().swap(counts);
+
+	// Merge the runs in (key, move) order, always taking from the run whose next count comes first
+	auto after = [&runs](size_t a, size_t b) {
+		const PositionCount* left = runs[a]->peek();
+		const PositionCount* right = runs[b]->peek();
+		return (left->key != right->key) ? left->key > right->key : left->move > right->move;
+	};
+	std::priority_queue<size_t, std::vector<size_t>, decltype(after)> heap(after);
+	for (size_t i = 0; i < runs.size(); i++) {
+		if (runs[i]->peek()) heap.push(i);
+	}
+
+	TempFile entryFile, moveFile;
+	if (!entryFile.open() || !moveFile.open()) {
+		std::cerr << "Failed to open a temporary file" << std::endl;
+		return false;
+	}
+	uint64_t positions = 0, moveCount = 0;
+	PositionDBEntry entry = {};
+	std::vector<PositionDBMove> entryMoves;
+	bool haveEntry = false, tooMany = false, wrote = true;
+
+	// Writes out the position being summed, unless too few games reached it
+	auto finishEntry = [&]() {
+		if (!haveEntry || entry.games() < options.minGames) return;
+		if (positions + 1 >= NULL_UINT || moveCount + entryMoves.size() >= NULL_UINT) {
+			tooMany = true;
+			return;
+		}
+		std::stable_sort(entryMoves.begin(), entryMoves.end(),
+			[](const PositionDBMove& a, const PositionDBMove& b) { return a.count > b.count; });
+		entry.firstMove = (uint32_t)moveCount;
+		wrote = writeAll(entryFile.file, &entry, 1) && writeAll(moveFile.file, entryMoves.data(), entryMoves.size()) && wrote;
+		positions++;
+		moveCount += entryMoves.size();
+	};
+
+	while (!heap.empty() && !tooMany) {
+		size_t run = heap.top();
+		heap.pop();
+		PositionCount count = *runs[run]->peek();
+		runs[run]->next++;
+		if (runs[run]->peek()) heap.push(run);
+
+		if (!haveEntry || count.key != entry.key) {
+			finishEntry();
+			entry = { count.key, 0, 0, 0, 0 };
+			entryMoves.clear();
+			haveEntry = true;
+		}
+		entry.whiteWins += count.results[0];
+		entry.draws += count.results[1];
+		entry.blackWins += count.results[2];
+
+		if (count.move == NO_DB_MOVE) continue;
+		if (!entryMoves.empty() && entryMoves.back().move == count.move) entryMoves.back().count += count.games();
+		else entryMoves.push_back({ count.move, 0, count.games() });
+	}
+	finishEntry();
+	runs.clear();
+
+	if (tooMany) {
+		std::cerr << "Too many positions for one position database; try -maxply or -mingames" << std::endl;
+		return false;
+	}
+	if (!wrote || std::fflush(entryFile.file) != 0 || std::fflush(moveFile.file) != 0) {
+		std::cerr << "Failed to write a temporary file while merging positions" << std::endl;
+		return false;
+	}
+
+	PositionDBHeader header = {};
+	memcpy(header.magic, POSITION_DB_MAGIC, sizeof(POSITION_DB_MAGIC));
+	header.version = POSITION_DB_VERSION;
+	while (header.indexBits < POSITION_DB_MAX_INDEX_BITS && ((uint64_t)POSITION_DB_BUCKET_SIZE << (header.indexBits + 1)) <= positions) {
+		header.indexBits++;
+	}
+	header.games = games;
+	header.positions = positions;
+	header.moves = moveCount;
+
+	// index[b] is the first entry in bucket b or later, so bucket b runs from index[b] to index[b + 1]
+	std::vector<uint32_t> index(((size_t)1 << header.indexBits) + 1);
+	std::vector<PositionDBEntry> block(RUN_READ_BLOCK);
+	size_t bucket = 0, read;
+	uint32_t entryIndex = 0;
+	std::rewind(entryFile.file);
+	while ((read = std::fread(block.data(), sizeof(PositionDBEntry), block.size(), entryFile.file)) > 0) {
+		for (size_t i = 0; i < read; i++, entryIndex++) {
+			uint32_t entryBucket = bucketOf(block[i].key, header.indexBits);
+			while (bucket <= entryBucket) index[bucket++] = entryIndex;
+		}
+	}
+	while (bucket < index.size()) index[bucket++] = entryIndex;
+	PositionDBEntry sentinel = { 0, 0, 0, 0, (uint32_t)moveCount };
+
+	std::FILE* file = std::fopen(outFile.c_str(), "wb");
+	if (!file) {
+		std::cerr << "Failed to open " << outFile << " for writing" << std::endl;
+		return false;
+	}
+	static const uint8_t padding[8] = {};
+	wrote = writeAll(file, &header, 1) && writeAll(file, padding, indexOffset() - sizeof(header))
+		&& writeAll(file, index.data(), index.size())
+		&& writeAll(file, padding, entriesOffset(header.indexBits) - indexOffset() - index.size() * sizeof(uint32_t))
+		&& copyAll(entryFile.file, file) && writeAll(file, &sentinel, 1) && copyAll(moveFile.file, file);
+	wrote = (std::fclose(file) == 0) && wrote;
+	if (!wrote) {
+		std::cerr << "Failed to write " << outFile << std::endl;
+		return false;
+	}
+
+	std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+	os << "Games:            " << games << std::endl;
+	os << "Skipped:          " << skipped << std::endl;
+	os << "Positions:        " << header.positions << std::endl;
+	os << "Moves:            " << header.moves << std::endl;
+	os << "Size (MB):        " << (entriesOffset(header.indexBits) + (positions + 1) * sizeof(PositionDBEntry)
+		+ moveCount * sizeof(PositionDBMove)) / (1024.0 * 1024.0) << std::endl;
+	os << "Time (s):         " << elapsed.count() << std::endl;
+	return true;
+}
+
+// Prints what the database knows about 'game', then times lookups of its key and of random ones
+static int probePositionDB(const PositionDB& db, const Game& game, std::ostream& os) {
+	const PositionDBEntry* entry = db.find(game);
+	if (!entry) os << "Position not in the database" << std::endl;
+	else {
+		os << "Games:            " << entry->games() << " (+" << entry->whiteWins << " =" << entry->draws << " -" << entry->blackWins << ")" << std::endl;
+		for (const PositionDBMove& move : db.getMoves(entry)) {
+			os << "  " << toSAN(game, move.toMove(game)) << " " << move.count << std::endl;
+		}
+	}
+
+	const int LOOKUPS = 1 << 20;
+	std::mt19937_64 random(0);
+	uint64_t found = 0;
+	auto start = std::chrono::steady_clock::now();
+	for (int i = 0; i < LOOKUPS; i++) {
+		// Alternate between a random key, almost surely missing, and the probed position's
+		uint64_t key = (i & 1) ? random() : positionDBKey(game);
+		found += db.find(key) != nullptr;
+	}
+	std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+	os << "Lookups/sec:      " << (uint64_t)(LOOKUPS / elapsed.count()) << " (" << found << " hits)" << std::endl;
+	return 0;
+}
+
+/*-------------------------------------------------------------------------------------------------------------*\
+* runPositionDB(int, char**, std::ostream&)
+*
+* Parameters: argc, argv - Arguments after 'db':
+*                build <out.db> <games.pgn>... [-maxply <n>] [-mingames <n>] [-memory <mb>]
+*                probe <file.db> [fen]
+*             os - Where results are printed
+* Description: Builds a database offline from PGN files, or looks up a position in one, the start position when
+*              no FEN is given
+* Return Value: Process exit code
+\*-------------------------------------------------------------------------------------------------------------*/
+int runPositionDB(int argc, char** argv, std::ostream& os) {
+	if (argc >= 3 && strcmp(argv[0], "build") == 0) {
+		PositionDBOptions options;
+		std::vector<std::string> pgnFiles;
+		for (int i = 2; i < argc; i++) {
+			if (strcmp(argv[i], "-maxply") == 0 && i + 1 < argc) options.maxPly = atoi(argv[++i]);
+			else if (strcmp(argv[i], "-mingames") == 0 && i + 1 < argc) options.minGames = std::max(1, atoi(argv[++i]));
+			else if (strcmp(argv[i], "-memory") == 0 && i + 1 < argc) options.memoryMB = std::max(1, atoi(argv[++i]));
+			else pgnFiles.push_back(argv[i]);
+		}
+		return buildPositionDB(pgnFiles, argv[1], options, os) ? 0 : 1;
+	}
+
+	if (argc >= 2 && strcmp(argv[0], "probe") == 0) {
+		PositionDB db;
+		if (!db.open(argv[1])) return 1;
+		Game game;
+		std::string fen;
+		for (int i = 2; i < argc; i++) fen += std::string(argv[i]) + " ";
+		if (!fen.empty() && !game.fromFEN(fen)) {
+			std::cerr << "Invalid FEN: " << fen << std::endl;
+			return 1;
+		}
+		os << "Database:         " << db.getGames() << " games, " << db.getPositions() << " positions" << std::endl;
+		return probePositionDB(db, game, os);
+	}
+
+	std::cerr << "Usage: db build <out.db> <games.pgn>... [-maxply <n>] [-mingames <n>] [-memory <mb>]" << std::endl;
+	std::cerr << "       db probe <file.db> [fen]" << std::endl;
+	return 1;
+}
@@ -0,0 +1,110 @@
+#pragma once
+#include "game.h"
+#include <iostream>
+#include <string>
+
+constexpr char POSITION_DB_MAGIC[8] = { 'C', 'A', 'I', 'P', 'O', 'S', 'D', 'B' };
+constexpr uint32_t POSITION_DB_VERSION = 1;
+// Average positions per index bucket the builder aims for
+constexpr uint64_t POSITION_DB_BUCKET_SIZE = 8;
+constexpr uint32_t POSITION_DB_MAX_INDEX_BITS = 24;
+
+/*-------------------------------------------------------------------------------------------------------------*\
+* File layout, little-endian and 8-byte aligned throughout:
+*
+*   PositionDBHeader
+*   uint32_t index[(1 << indexBits) + 1]		First position whose key starts with each 'indexBits'-bit prefix
+*   PositionDBEntry entries[positions + 1]		Sorted by key; the last is a sentinel holding the end of the moves
+*   PositionDBMove moves[moves]					Grouped by position, most played first
+\*-------------------------------------------------------------------------------------------------------------*/
+struct PositionDBHeader {
+	char magic[8];
+	uint32_t version;
+	uint32_t indexBits;
+	uint64_t games;
+	uint64_t positions;
+	uint64_t moves;
+};
+
+// Entries are keyed by Game::getKey(), which already leaves out an en passant square no pawn can take, so move
+// orders that differ only in such a double push reach the same entry
+inline uint64_t positionDBKey(const Game& game) { return game.getKey(); }
+
+// How the games through one position ended, from white's side
+struct PositionDBEntry {
+	uint64_t key;				// positionDBKey() of the position
+	uint32_t whiteWins;
+	uint32_t draws;
+	uint32_t blackWins;
+	uint32_t firstMove;			// This position's moves run up to the next entry's firstMove
+
+	uint32_t games() const { return whiteWins + draws + blackWins; }
+};
+
+// A move played from a position and how often. The move is packed like MoveHasher does it
+struct PositionDBMove {
+	uint16_t move;
+	uint16_t reserved;
+	uint32_t count;
+
+	Move toMove(const Game& game) const { return Move(game, move & 0x3F, (move >> 6) & 0x3F, (PieceType)(move >> 12)); }
+};
+
+// The moves of one position, pointing into the mapped file
+struct PositionDBMoves {
+	const PositionDBMove* first = nullptr;
+	const PositionDBMove* last = nullptr;
+
+	const PositionDBMove* begin() const { return first; }
+	const PositionDBMove* end() const { return last; }
+	size_t size() const { return last - first; }
+};
+
+/*-------------------------------------------------------------------------------------------------------------*\
+* PositionDB
+*
+* Description: A read-only view of a position database file. The file is memory-mapped, so opening it costs
+*              nothing up front and every process reading the same file shares one copy in the page cache.
+*              A lookup reads the index bucket for the key's top bits and binary searches the few positions in it
+\*-------------------------------------------------------------------------------------------------------------*/
+class PositionDB {
+	const uint8_t* data = nullptr;
+	size_t size = 0;
+	const PositionDBHeader* header = nullptr;
+	const uint32_t* index = nullptr;
+	const PositionDBEntry* entries = nullptr;
+	const PositionDBMove* moves = nullptr;
+
+public:
+	PositionDB() {}
+	PositionDB(const PositionDB&) = delete;
+	PositionDB& operator=(const PositionDB&) = delete;
+	~PositionDB();
+
+	// Maps 'path'. Returns false if it can't be opened or isn't a database this build can read
+	bool open(const std::string& path);
+	void close();
+	bool isOpen() const { return data != nullptr; }
+
+	// The position with this key, or nullptr if no game reached it
+	const PositionDBEntry* find(uint64_t key) const;
+	const PositionDBEntry* find(const Game& game) const { return find(positionDBKey(game)); }
+	PositionDBMoves getMoves(const PositionDBEntry*) const;
+
+	uint64_t getGames() const { return header ? header->games : 0; }
+	uint64_t getPositions() const { return header ? header->positions : 0; }
+};
+
+// Settings for building a database
+struct PositionDBOptions {
+	int maxPly = 0;				// Positions this many plies into a game are the last kept, or 0 for all
+	uint32_t minGames = 1;		// Positions reached fewer times than this are left out
+	size_t memoryMB = 256;		// Positions collected before they're sorted and spilled to a temporary file
+};
+
+// Replays every game in the PGN files and writes the positions they reached to 'outFile'. Games without a result
+// are skipped. Returns false if a file can't be read or written
+bool buildPositionDB(const std::vector<std::string>& pgnFiles, const std::string& outFile,
+	const PositionDBOptions& = PositionDBOptions(), std::ostream& os = std::cout);
+// Runs 'db build' or 'db probe' from the command line, after 'db'. Returns the process exit code
+int runPositionDB(int argc, char** argv, std::ostream& os = std::cout);
@@ -0,0 +1,37 @@
+#include "SearchStats.h"
+#include <algorithm>
+#include <sstream>
+
+// Everything adds up except depth, which is the deepest any of them went. Time adds up too, so after summing
+// threads nodesPerSecond() is the speed of one thread
+SearchStats& SearchStats::operator+=(const SearchStats& other) {
+	iterations += other.iterations;
+	nodes += other.nodes;
+	expansions += other.expansions;
+	terminalNodes += other.terminalNodes;
+	evaluations += other.evaluations;
+	pawnHashProbes += other.pawnHashProbes;
+	pawnHashHits += other.pawnHashHits;
+	maxDepth = std::max(maxDepth, other.maxDepth);
+	seconds += other.seconds;
+	return *this;
+}
+
+std::string SearchStats::toJSON() const {
+	std::ostringstream json;
+	json << "{"
+		<< "\"iterations\":" << iterations << ","
+		<< "\"nodes\":" << nodes << ","
+		<< "\"expansions\":" << expansions << ","
+		<< "\"terminalNodes\":" << terminalNodes << ","
+		<< "\"evaluations\":" << evaluations << ","
+		<< "\"pawnHashProbes\":" << pawnHashProbes << ","
+		<< "\"pawnHashHits\":" << pawnHashHits << ","
+		<< "\"pawnHashHitRate\":" << pawnHashHitRate() << ","
+		<< "\"branchingFactor\":" << branchingFactor() << ","
+		<< "\"maxDepth\":" << maxDepth << ","
+		<< "\"seconds\":" << seconds << ","
+		<< "\"nodesPerSecond\":" << (uint64_t)nodesPerSecond()
+		<< "}";
+	return json.str();
+}
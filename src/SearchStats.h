@@ -0,0 +1,26 @@
+#pragma once
+#include <stdint.h>
+#include <string>
+
+// Counters filled in by the tree search. Plain integers so the hot path only pays for an increment; searches run
+// on several threads each keep their own and are summed with += afterwards
+struct SearchStats {
+	uint64_t iterations = 0;		// Search iterations run
+	uint64_t nodes = 0;				// Tree nodes created
+	uint64_t expansions = 0;		// Leaves whose moves were generated
+	uint64_t terminalNodes = 0;		// Expanded leaves with no legal moves (mate or stalemate)
+	uint64_t evaluations = 0;		// Static evaluations
+	uint64_t pawnHashProbes = 0;	// Pawn structure cache lookups made by the evaluator
+	uint64_t pawnHashHits = 0;
+	uint64_t maxDepth = 0;			// Deepest ply expanded below the root
+	double seconds = 0.0;			// Time spent searching
+
+	SearchStats& operator+=(const SearchStats&);
+	void clear() { *this = SearchStats(); }
+
+	double nodesPerSecond() const { return (seconds > 0) ? nodes / seconds : 0.0; }
+	double pawnHashHitRate() const { return (pawnHashProbes) ? (double)pawnHashHits / pawnHashProbes : 0.0; }
+	double branchingFactor() const { return (expansions) ? (double)nodes / expansions : 0.0; }
+
+	std::string toJSON() const;
+};
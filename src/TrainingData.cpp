@@ -0,0 +1,136 @@
+#include "TrainingData.h"
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+
+TrainingWriter::TrainingWriter(size_t bufferRecords) : buffer(std::max<size_t>(1, bufferRecords)) {}
+
+TrainingWriter::~TrainingWriter() {
+	close();
+}
+
+bool TrainingWriter::open(const std::string& path, bool append) {
+	close();
+	file = std::fopen(path.c_str(), append ? "ab" : "wb");
+	if (!file) std::cerr << "Failed to open training file " << path << std::endl;
+	return file != nullptr;
+}
+
+void TrainingWriter::write(const TrainingRecord& record) {
+	if (used == buffer.size()) flush();
+	buffer[used++] = record;
+}
+
+void TrainingWriter::write(const std::vector<TrainingRecord>& records) {
+	for (const TrainingRecord& record : records) write(record);
+}
+
+bool TrainingWriter::flush() {
+	if (!file || !used) return file != nullptr;
+	size_t wrote = std::fwrite(buffer.data(), sizeof(TrainingRecord), used, file);
+	written += wrote;
+	bool complete = wrote == used;
+	if (!complete) std::cerr << "Failed to write " << used - wrote << " training records" << std::endl;
+	used = 0;
+	return complete;
+}
+
+void TrainingWriter::close() {
+	if (!file) return;
+	flush();
+	std::fclose(file);
+	file = nullptr;
+}
+
+
+TrainingReader::TrainingReader(size_t bufferRecords) : buffer(std::max<size_t>(1, bufferRecords)) {}
+
+TrainingReader::~TrainingReader() {
+	close();
+}
+
+bool TrainingReader::open(const std::string& path) {
+	close();
+	file = std::fopen(path.c_str(), "rb");
+	if (!file) std::cerr << "Failed to open training file " << path << std::endl;
+	return file != nullptr;
+}
+
+void TrainingReader::close() {
+	if (file) std::fclose(file);
+	file = nullptr;
+	used = filled = 0;
+}
+
+bool TrainingReader::next(TrainingRecord& record) {
+	if (used == filled) {
+		if (!file) return false;
+		filled = std::fread(buffer.data(), sizeof(TrainingRecord), buffer.size(), file);
+		used = 0;
+		if (!filled) return false;
+	}
+	record = buffer[used++];
+	return true;
+}
+
+size_t TrainingReader::read(TrainingRecord* records, size_t count) {
+	size_t copied = 0;
+	while (copied < count) {
+		// Whatever is left in the buffer first, then large requests go straight into the caller's memory
+		if (used < filled) {
+			size_t take = std::min(filled - used, count - copied);
+			memcpy(records + copied, buffer.data() + used, take * sizeof(TrainingRecord));
+			used += take;
+			copied += take;
+		}
+		else if (!file) break;
+		else if (count - copied >= buffer.size()) {
+			size_t got = std::fread(records + copied, sizeof(TrainingRecord), count - copied, file);
+			copied += got;
+			if (!got) break;
+		}
+		else {
+			filled = std::fread(buffer.data(), sizeof(TrainingRecord), buffer.size(), file);
+			used = 0;
+			if (!filled) break;
+		}
+	}
+	return copied;
+}
+
+std::string trainingShardPath(const std::string& path, int index) {
+	size_t dot = path.find_last_of('.');
+	size_t slash = path.find_last_of("/\\");
+	if (dot == std::string::npos || (slash != std::string::npos && dot < slash)) return path + "." + std::to_string(index);
+	return path.substr(0, dot) + "." + std::to_string(index) + path.substr(dot);
+}
+
+int runTrainingStats(const char* filepath, std::ostream& os) {
+	TrainingReader reader;
+	if (!reader.open(filepath)) return 1;
+
+	auto start = std::chrono::steady_clock::now();
+	std::vector<TrainingRecord> records(TRAINING_BUFFER_RECORDS);
+	uint64_t total = 0, results[3] = { 0, 0, 0 };
+	int64_t scoreSum = 0;
+	size_t got;
+	while ((got = reader.read(records.data(), records.size())) > 0) {
+		for (size_t i = 0; i < got; i++) {
+			results[std::min(std::max(records[i].result + 1, 0), 2)]++;
+			scoreSum += records[i].getScore();
+		}
+		total += got;
+	}
+	std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+	double megabytes = total * sizeof(TrainingRecord) / (1024.0 * 1024.0);
+	os << "Records:          " << total << std::endl;
+	os << "White wins:       " << results[2] << std::endl;
+	os << "Draws:            " << results[1] << std::endl;
+	os << "Black wins:       " << results[0] << std::endl;
+	os << "Mean score:       " << ((total) ? (double)scoreSum / total : 0.0) << std::endl;
+	os << "Size (MB):        " << megabytes << std::endl;
+	os << "Records/sec:      " << (uint64_t)((elapsed.count() > 0) ? total / elapsed.count() : 0) << std::endl;
+	os << "MB/sec:           " << ((elapsed.count() > 0) ? megabytes / elapsed.count() : 0.0) << std::endl;
+	return 0;
+}
@@ -0,0 +1,88 @@
+#pragma once
+#include "PackedPosition.h"
+#include <cstdio>
+#include <iostream>
+#include <string>
+#include <vector>
+
+// Records held in memory before a write or after a read, 2MB worth
+constexpr size_t TRAINING_BUFFER_RECORDS = 1 << 16;
+
+// Game results as stored in a record, from white's side
+constexpr int8_t TRAINING_WHITE_WIN = 1;
+constexpr int8_t TRAINING_DRAW = 0;
+constexpr int8_t TRAINING_BLACK_WIN = -1;
+
+// One training sample: a position, the search's score for it and how the game went. Like PackedPosition it is
+// all bytes; the score is little-endian. Files are nothing but records back to back, so shards can be joined by
+// concatenating them
+struct TrainingRecord {
+	PackedPosition position;
+	uint8_t score[2];		// Centipawns, positive favors white
+	int8_t result;			// TRAINING_WHITE_WIN, TRAINING_DRAW or TRAINING_BLACK_WIN
+	uint8_t reserved;
+
+	int16_t getScore() const { return (int16_t)(score[0] | (score[1] << 8)); }
+	void setScore(int16_t value) {
+		score[0] = (uint8_t)(value & 0xFF);
+		score[1] = (uint8_t)((uint16_t)value >> 8);
+	}
+};
+static_assert(sizeof(TrainingRecord) == 32, "TrainingRecord should stay 32 bytes");
+
+/*-------------------------------------------------------------------------------------------------------------*\
+* TrainingWriter
+*
+* Description: Appends records to a file through a large buffer, so generating data costs one fwrite per
+*              TRAINING_BUFFER_RECORDS samples. Not thread safe: give each thread its own shard, or lock around it
+\*-------------------------------------------------------------------------------------------------------------*/
+class TrainingWriter {
+	std::FILE* file = nullptr;
+	std::vector<TrainingRecord> buffer;
+	size_t used = 0;
+	uint64_t written = 0;
+
+public:
+	TrainingWriter(size_t bufferRecords = TRAINING_BUFFER_RECORDS);
+	~TrainingWriter();
+
+	// Opens 'path' for writing, after what is already there unless 'append' is false
+	bool open(const std::string& path, bool append = true);
+	void write(const TrainingRecord& record);
+	void write(const std::vector<TrainingRecord>& records);
+	bool flush();
+	void close();
+	bool isOpen() const { return file != nullptr; }
+	// Records written so far, counting those still in the buffer
+	uint64_t count() const { return written + used; }
+};
+
+/*-------------------------------------------------------------------------------------------------------------*\
+* TrainingReader
+*
+* Description: Reads records back a buffer at a time. A trailing partial record, as left by a writer that was
+*              killed mid-write, is ignored
+\*-------------------------------------------------------------------------------------------------------------*/
+class TrainingReader {
+	std::FILE* file = nullptr;
+	std::vector<TrainingRecord> buffer;
+	size_t used = 0;
+	size_t filled = 0;
+
+public:
+	TrainingReader(size_t bufferRecords = TRAINING_BUFFER_RECORDS);
+	~TrainingReader();
+
+	bool open(const std::string& path);
+	void close();
+	// Copies the next record into 'record'. Returns false at the end of the file
+	bool next(TrainingRecord& record);
+	// Copies up to 'count' records into 'records'. Returns how many were copied, 0 at the end of the file
+	size_t read(TrainingRecord* records, size_t count);
+};
+
+// Name of shard 'index' of 'path': "data.bin" becomes "data.3.bin"
+std::string trainingShardPath(const std::string& path, int index);
+// Reads a training file and prints the record count, the spread of results and the read rate. Returns the process
+// exit code
+int runTrainingStats(const char* filepath, std::ostream& os = std::cout);
@@ -11,7 +11,7 @@ VAO::~VAO() {
 }
 
 /*-------------------------------------------------------------------------------------------------------------*\
-* VAO::linkAttribute(VBO*, GLuint, GLuint, GLenum, GLsizeiptr, void*)
+* VAO::linkAttribute(VBO*, GLuint, GLuint, GLenum, GLsizeiptr, void*, GLuint)
 * 
 * Parameters: vbo - Pointer to the vbo containing the attribute
 *             layout - Attribute index
@@ -19,12 +19,14 @@ VAO::~VAO() {
 *             type - Primitive data type of the components
 *             stride - Total length of data between vertices, in bytes
 *             offset - Offset to the beginning of this attribute's data, in bytes as a void pointer
+*             divisor - 0 to advance the attribute per vertex, 1 to advance it per instance
 * Description: Links an attribute in 'vbo' to the VAO
 \*-------------------------------------------------------------------------------------------------------------*/
-void VAO::linkAttribute(VBO* vbo, GLuint layout, GLuint numComponents, GLenum type, GLsizeiptr stride, void* offset) {
+void VAO::linkAttribute(VBO* vbo, GLuint layout, GLuint numComponents, GLenum type, GLsizeiptr stride, void* offset, GLuint divisor) {
 	vbo->bind();
 	glVertexAttribPointer(layout, numComponents, type, GL_FALSE, stride, offset);
 	glEnableVertexAttribArray(layout);
+	glVertexAttribDivisor(layout, divisor);
 	vbo->unbind();
 }
 
@@ -10,7 +10,7 @@ public:
 
 	VAO();
 	~VAO();
-	void linkAttribute(VBO* vbo, GLuint layout, GLuint numComponents, GLenum type, GLsizeiptr stride, void* offset);
+	void linkAttribute(VBO* vbo, GLuint layout, GLuint numComponents, GLenum type, GLsizeiptr stride, void* offset, GLuint divisor = 0);
 	void bind();
 	void unbind();
 };
\ No newline at end of file
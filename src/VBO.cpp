@@ -1,15 +1,16 @@
 # include "VBO.h"
 
 /*-------------------------------------------------------------------------------------------------------------*\
-* VBO::VBO(GLfloat*, GLsizeiptr)
+* VBO::VBO(const void*, GLsizeiptr, GLenum)
 * 
-* Parameters: vertices - Pointer to contiguous data array of vertex information for the VBO, in floats
+* Parameters: vertices - Pointer to contiguous data array of vertex information for the VBO
 *             size - Size of the 'vertices' array, in bytes
+*             usage - GL_STATIC_DRAW for data set once, GL_DYNAMIC_DRAW for data replaced with setData()
 \*-------------------------------------------------------------------------------------------------------------*/
-VBO::VBO(GLfloat* vertices, GLsizeiptr size) {
+VBO::VBO(const void* vertices, GLsizeiptr size, GLenum usage) : usage(usage) {
 	glGenBuffers(1, &ID);
 	bind();
-	glBufferData(GL_ARRAY_BUFFER, size, vertices, GL_STATIC_DRAW);
+	glBufferData(GL_ARRAY_BUFFER, size, vertices, usage);
 }
 
 // Deletes the opengl object for this VBO
@@ -22,6 +23,12 @@ void VBO::bind() {
 	glBindBuffer(GL_ARRAY_BUFFER, ID);
 }
 
+// Replaces the VBO's contents, leaving it bound
+void VBO::setData(const void* vertices, GLsizeiptr size) {
+	bind();
+	glBufferData(GL_ARRAY_BUFFER, size, vertices, usage);
+}
+
 // Unbinds the active VBO
 void VBO::unbind() {
 	glBindBuffer(GL_ARRAY_BUFFER, 0);
@@ -6,9 +6,11 @@
 class VBO {
 public:
 	GLuint ID;
+	GLenum usage;
 
-	VBO(GLfloat* vertices, GLsizeiptr size);
+	VBO(const void* vertices, GLsizeiptr size, GLenum usage = GL_STATIC_DRAW);
 	~VBO();
 	void bind();
 	void unbind();
+	void setData(const void* vertices, GLsizeiptr size);
 };
\ No newline at end of file
@@ -0,0 +1,79 @@
+#include "attacks.h"
+
+// Directions for the slider rays, the ones toward higher square numbers first
+enum Direction { NORTH, EAST, NORTH_EAST, NORTH_WEST, SOUTH, WEST, SOUTH_EAST, SOUTH_WEST };
+constexpr int directionSteps[8][2] = { { 0, 1 }, { 1, 0 }, { 1, 1 }, { -1, 1 }, { 0, -1 }, { -1, 0 }, { 1, -1 }, { -1, -1 } };
+
+// Attack sets of the non-sliding pieces and empty board rays for every square, built once
+struct AttackTables {
+	Bitboard knight[64];
+	Bitboard king[64];
+	Bitboard pawn[2][64];	// indexed white, black
+	Bitboard rays[8][64];	// Empty board rays in each Direction
+
+	AttackTables() {
+		const int knightSteps[8][2] = { { 1, 2 }, { 2, 1 }, { 2, -1 }, { 1, -2 }, { -1, -2 }, { -2, -1 }, { -2, 1 }, { -1, 2 } };
+		const int kingSteps[8][2] = { { 1, 0 }, { 1, 1 }, { 0, 1 }, { -1, 1 }, { -1, 0 }, { -1, -1 }, { 0, -1 }, { 1, -1 } };
+		for (int square = 0; square < 64; square++) {
+			int file = square % 8;
+			int rank = square / 8;
+			knight[square] = king[square] = 0;
+			for (int i = 0; i < 8; i++) {
+				knight[square] |= stepBB(file + knightSteps[i][0], rank + knightSteps[i][1]);
+				king[square] |= stepBB(file + kingSteps[i][0], rank + kingSteps[i][1]);
+			}
+			pawn[0][square] = stepBB(file - 1, rank + 1) | stepBB(file + 1, rank + 1);
+			pawn[1][square] = stepBB(file - 1, rank - 1) | stepBB(file + 1, rank - 1);
+
+			for (int direction = 0; direction < 8; direction++) {
+				rays[direction][square] = 0;
+				int f = file + directionSteps[direction][0];
+				int r = rank + directionSteps[direction][1];
+				for (; ON_BOARD(f) && ON_BOARD(r); f += directionSteps[direction][0], r += directionSteps[direction][1]) {
+					rays[direction][square] |= squareBB(r * 8 + f);
+				}
+			}
+		}
+	}
+
+	static Bitboard stepBB(int file, int rank) {
+		return (ON_BOARD(file) && ON_BOARD(rank)) ? squareBB(rank * 8 + file) : 0;
+	}
+};
+
+static const AttackTables& tables() {
+	static const AttackTables attackTables;
+	return attackTables;
+}
+
+// The ray from 'square' in one direction, cut off after the first piece in the way. Rays toward higher squares meet
+// their nearest blocker at the lowest bit, rays going down at the highest
+static Bitboard rayAttacks(int square, Direction direction, Bitboard occupied) {
+	Bitboard ray = tables().rays[direction][square];
+	Bitboard blockers = ray & occupied;
+	if (!blockers) return ray;
+	int blocker = (direction <= NORTH_WEST) ? lsb(blockers) : msb(blockers);
+	return ray ^ tables().rays[direction][blocker];
+}
+
+Bitboard knightAttacks(int square) {
+	return tables().knight[square];
+}
+
+Bitboard kingAttacks(int square) {
+	return tables().king[square];
+}
+
+Bitboard pawnAttacks(Color color, int square) {
+	return tables().pawn[(color == white) ? 0 : 1][square];
+}
+
+Bitboard bishopAttacks(int square, Bitboard occupied) {
+	return rayAttacks(square, NORTH_EAST, occupied) | rayAttacks(square, NORTH_WEST, occupied)
+		| rayAttacks(square, SOUTH_EAST, occupied) | rayAttacks(square, SOUTH_WEST, occupied);
+}
+
+Bitboard rookAttacks(int square, Bitboard occupied) {
+	return rayAttacks(square, EAST, occupied) | rayAttacks(square, WEST, occupied)
+		| rayAttacks(square, NORTH, occupied) | rayAttacks(square, SOUTH, occupied);
+}
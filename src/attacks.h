@@ -0,0 +1,10 @@
+#pragma once
+#include "bitboard.h"
+#include "util.h"
+
+// Squares attacked by a piece standing on 'square'. Sliders stop at the first occupied square in each direction
+Bitboard knightAttacks(int square);
+Bitboard kingAttacks(int square);
+Bitboard pawnAttacks(Color, int square);
+Bitboard bishopAttacks(int square, Bitboard occupied);
+Bitboard rookAttacks(int square, Bitboard occupied);
@@ -0,0 +1,91 @@
+#include "batch.h"
+#include "MiniMaxTree.h"
+#include <atomic>
+#include <functional>
+#include <thread>
+
+// Positions a worker takes at a time, so threads don't contend on the shared counter for every position
+constexpr size_t BATCH_CHUNK = 64;
+
+// Sets up position 'index', or returns nullptr if it can't be read
+typedef std::function<std::shared_ptr<Game>(size_t index)> BatchSetUp;
+
+/*-------------------------------------------------------------------------------------------------------------*\
+* evaluatePosition(std::shared_ptr<Game>, Evaluator*, uint64_t)
+*
+* Parameters: game - Position to score
+*             evaluator - The calling worker's own evaluator
+*             iterations - Search budget, 0 for a static evaluation
+* Description: Scores the position, searching it first when there's a budget
+\*-------------------------------------------------------------------------------------------------------------*/
+static BatchResult evaluatePosition(std::shared_ptr<Game> game, Evaluator* evaluator, uint64_t iterations) {
+	BatchResult result;
+	if (iterations == 0) {
+		result.score = evaluator->evaluate(*game);
+		return result;
+	}
+
+	MMTNode root(game, 0, game->whoseTurn(), evaluator);
+	MiniMaxTree tree(&root);
+	tree.search(iterations);
+	result.score = root.eval;
+	result.move = root.bestMove;
+	return result;
+}
+
+/*-------------------------------------------------------------------------------------------------------------*\
+* runBatch(size_t, const BatchSetUp&, const BatchOptions&)
+*
+* Parameters: count - Number of positions
+*             setUp - Reads position i into a game, called on the worker that scores it
+*             options - Search budget, thread count and evaluator
+* Description: Workers claim chunks of positions from a shared counter until none are left. Each keeps its own
+*              evaluator (and with it its own pawn hash) and search tree, so nothing is locked while scoring.
+*              Results are written straight into their slot, which keeps them in input order
+* Return Value: One result per position
+\*-------------------------------------------------------------------------------------------------------------*/
+static std::vector<BatchResult> runBatch(size_t count, const BatchSetUp& setUp, const BatchOptions& options) {
+	std::vector<BatchResult> results(count);
+	if (count == 0) return results;
+
+	unsigned int numThreads = options.threads;
+	if (numThreads == 0) numThreads = std::max(1u, std::thread::hardware_concurrency());
+	size_t numChunks = (count + BATCH_CHUNK - 1) / BATCH_CHUNK;
+	if (numThreads > numChunks) numThreads = (unsigned int)numChunks;
+
+	// Load a network up front so workers don't race to do it
+	if (options.evaluator == "nnue") createEvaluator("nnue", options.nnueFile);
+
+	std::atomic<size_t> nextChunk(0);
+	auto worker = [&]() {
+		std::shared_ptr<Evaluator> evaluator = createEvaluator(options.evaluator, options.nnueFile);
+		size_t chunk;
+		while ((chunk = nextChunk.fetch_add(1)) < numChunks) {
+			size_t end = std::min(count, (chunk + 1) * BATCH_CHUNK);
+			for (size_t i = chunk * BATCH_CHUNK; i < end; i++) {
+				std::shared_ptr<Game> game = setUp(i);
+				if (!game) results[i].valid = false;
+				else results[i] = evaluatePosition(game, evaluator.get(), options.iterations);
+			}
+		}
+	};
+
+	std::vector<std::thread> pool;
+	for (unsigned int i = 1; i < numThreads; i++) pool.emplace_back(worker);
+	worker();
+	for (std::thread& thread : pool) thread.join();
+	return results;
+}
+
+// Sets each position up directly from its packed form
+std::vector<BatchResult> evaluateBatch(const PackedPosition* positions, size_t count, const BatchOptions& options) {
+	return runBatch(count, [positions](size_t i) { return std::make_shared<Game>(positions[i]); }, options);
+}
+
+// Parses each FEN on its worker, so reading the batch is spread over the pool too
+std::vector<BatchResult> evaluateBatch(const std::vector<std::string>& fens, const BatchOptions& options) {
+	return runBatch(fens.size(), [&fens](size_t i) {
+		std::shared_ptr<Game> game = std::make_shared<Game>();
+		return game->fromFEN(fens[i]) ? game : nullptr;
+	}, options);
+}
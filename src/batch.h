@@ -0,0 +1,28 @@
+#pragma once
+#include "PackedPosition.h"
+#include "game.h"
+#include "Evaluator.h"
+#include <vector>
+#include <string>
+
+// How a batch of positions is scored
+struct BatchOptions {
+	uint64_t iterations = 0;			// Tree search iterations per position. 0 only runs the static evaluation
+	unsigned int threads = 0;			// Worker threads. 0 uses one per hardware thread
+	std::string evaluator = "pst";		// Evaluator each worker makes for itself, as for createEvaluator
+	const char* nnueFile = DEFAULT_NNUE_FILE;	// Network for the "nnue" evaluator, loaded in place of any other
+};
+
+// Score of one position in centipawns (positive favors white) and the move the search picked, promotion included.
+// 'move.piece' is NO_PIECE when there was no search or no legal move. 'valid' is false when the position couldn't
+// be read, and the rest is left empty
+struct BatchResult {
+	int score = 0;
+	Move move;
+	bool valid = true;
+};
+
+// Scores 'count' positions across a pool of threads. Results come back in the same order as the positions
+std::vector<BatchResult> evaluateBatch(const PackedPosition* positions, size_t count, const BatchOptions& = BatchOptions());
+// Scores positions given in FEN, each parsed by the worker that scores it
+std::vector<BatchResult> evaluateBatch(const std::vector<std::string>& fens, const BatchOptions& = BatchOptions());
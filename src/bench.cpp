@@ -0,0 +1,227 @@
+#include "bench.h"
+#include "Evaluator.h"
+#include "MiniMaxTree.h"
+#include "batch.h"
+#include <chrono>
+#include <sstream>
+
+constexpr int BENCH_GAMES = 8;
+constexpr int BENCH_PLIES = 30;
+constexpr int EVAL_REPETITIONS = 5000;
+constexpr int SEARCH_POSITIONS = 4;
+constexpr int SEARCH_ITERATIONS = 2000;
+constexpr int BENCH_MULTI_PV = 3;
+// Enough that the signature run takes a second or two, so its nodes/second measures the search rather than the timer
+constexpr int BENCH_SEARCH_ITERATIONS = 3000;
+
+// Fixed positions for the node count signature, as moves from the starting position in coordinate notation
+static const char* benchPositions[] = {
+	"",
+	"e2e4 e7e5 g1f3 b8c6 f1b5 a7a6",
+	"d2d4 d7d5 c2c4 e7e6 b1c3 g8f6 c1g5 f8e7",
+	"e2e4 c7c5 g1f3 d7d6 d2d4 c5d4 f3d4 g8f6 b1c3 a7a6",
+	"e2e4 e7e6 d2d4 d7d5 b1c3 f8b4 e4e5 c7c5",
+	"d2d4 g8f6 c2c4 g7g6 b1c3 f8g7 e2e4 d7d6 g1f3 e8g8",
+	"e2e4 e7e5 g1f3 b8c6 f1c4 f8c5 e1g1 g8f6 d2d3 d7d6 c1g5 h7h6 g5h4 g7g5",
+	"e2e4 d7d5 e4d5 d8d5 b1c3 d5a5 d2d4 c7c6 g1f3 c8f5 f1c4 e7e6 e1g1",
+	"c2c4 e7e5 b1c3 g8f6 g1f3 b8c6 g2g3 d7d5 c4d5 f6d5",
+	"e2e4 c7c6 d2d4 d7d5 e4e5 c8f5 g1f3 e7e6 f1e2 c6c5",
+	"d2d4 d7d5 c2c4 d5c4 g1f3 g8f6 e2e3 e7e6 f1c4 c7c5 e1g1 a7a6",
+	"e2e4 e7e5 g1f3 g8f6 f3e5 d7d6 e5f3 f6e4 d2d4 d6d5 f1d3",
+	"g1f3 d7d5 g2g3 g8f6 f1g2 e7e6 e1g1 f8e7 d2d3 e8g8",
+	"e2e4 c7c5 b1c3 b8c6 g2g3 g7g6 f1g2 f8g7 d2d3 d7d6 c1e3 e7e5 d1d2",
+	"e2e4 d7d5 e4d5 d8d5 d1f3 d5f3 g1f3 c8g4 f1e2 g4f3 e2f3",
+	"d2d4 e7e6 c2c4 f8b4 c1d2 b4d2 d1d2 g8f6 b1c3 e8g8",
+};
+
+/*-------------------------------------------------------------------------------------------------------------*\
+* collectPositions(std::vector<std::shared_ptr<Game>>*)
+*
+* Parameters: positions - Output list of positions
+* Description: Plays a few games of pseudo-random moves from a fixed seed and keeps every position along the way,
+*              so each run benchmarks the same mix of openings, middlegames and endgames
+\*-------------------------------------------------------------------------------------------------------------*/
+static void collectPositions(std::vector<std::shared_ptr<Game>>* positions) {
+	uint32_t seed = 0x2545F491;
+	for (int g = 0; g < BENCH_GAMES; g++) {
+		std::shared_ptr<Game> game = std::make_shared<Game>();
+		Color toMove = white;
+		for (int ply = 0; ply < BENCH_PLIES && game->getPlayStatus() == PLAYING; ply++) {
+			std::vector<Move> moves;
+			game->getAllLegalMoves(&moves, toMove);
+			if (moves.empty()) break;
+
+			seed = seed * 1664525 + 1013904223;
+			Move move = moves[(seed >> 8) % moves.size()];
+			game->makePlayerMove(move);
+			positions->push_back(std::make_shared<Game>(game));
+			toMove = (toMove == white) ? black : white;
+		}
+	}
+}
+
+/*-------------------------------------------------------------------------------------------------------------*\
+* benchEvaluator(Evaluator*, const std::vector<std::shared_ptr<Game>>&, std::ostream&)
+*
+* Description: Times repeated static evaluations of every position and prints evaluations per second
+\*-------------------------------------------------------------------------------------------------------------*/
+static void benchEvaluator(Evaluator* evaluator, const std::vector<std::shared_ptr<Game>>& positions, std::ostream& os) {
+	int64_t checksum = 0;
+	double pawnHitRate = 0.0;
+
+	// One pass over the positions in game order shows how often the pawn hash hits in practice
+	PSTEvaluator* pst = dynamic_cast<PSTEvaluator*>(evaluator);
+	if (pst) {
+		pst->getPawnTable().clear();
+		pst->getPawnTable().resetCounters();
+		for (const std::shared_ptr<Game>& position : positions) evaluator->evaluate(*position);
+		pawnHitRate = pst->getPawnTable().hitRate();
+	}
+
+	auto start = std::chrono::steady_clock::now();
+	for (int rep = 0; rep < EVAL_REPETITIONS; rep++) {
+		for (const std::shared_ptr<Game>& position : positions) {
+			checksum += evaluator->evaluate(*position);
+		}
+	}
+	std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+	uint64_t evaluations = (uint64_t)positions.size() * EVAL_REPETITIONS;
+	os << "Evaluator:        " << evaluator->name() << "\n";
+	os << "Evaluations:      " << evaluations << "\n";
+	os << "Checksum:         " << checksum << "\n";
+	os << "Time (s):         " << elapsed.count() << "\n";
+	os << "Evaluations/sec:  " << (uint64_t)(evaluations / elapsed.count()) << "\n";
+	if (pst) os << "Pawn hash hits:   " << pawnHitRate * 100 << "%\n";
+}
+
+/*-------------------------------------------------------------------------------------------------------------*\
+* benchSearch(Evaluator*, const std::vector<std::shared_ptr<Game>>&, int, std::ostream&)
+*
+* Parameters: multiPV - Number of root lines to search
+* Description: Runs a fixed number of tree search iterations on a spread of the positions and prints the time
+*              taken, so single line and multi-PV searches can be compared
+* Return Value: Time taken in seconds
+\*-------------------------------------------------------------------------------------------------------------*/
+static double benchSearch(Evaluator* evaluator, const std::vector<std::shared_ptr<Game>>& positions, int multiPV, std::ostream& os) {
+	size_t step = std::max<size_t>(1, positions.size() / SEARCH_POSITIONS);
+	size_t lines = 0;
+	SearchStats stats;
+
+	auto start = std::chrono::steady_clock::now();
+	for (size_t i = 0; i < positions.size(); i += step) {
+		MMTNode root(positions[i], 0, positions[i]->whoseTurn(), evaluator);
+		MiniMaxTree tree(&root);
+		tree.setMultiPV(multiPV);
+		tree.search(SEARCH_ITERATIONS);
+		lines += tree.getLines().size();
+		stats += tree.getStats();
+	}
+	std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+	os << "MultiPV " << multiPV << " time (s): " << elapsed.count() << " (" << lines << " lines)\n";
+	os << "Search stats:     " << stats.toJSON() << "\n";
+	return elapsed.count();
+}
+
+/*-------------------------------------------------------------------------------------------------------------*\
+* setUpPosition(const char*)
+*
+* Parameters: moves - Space separated moves in coordinate notation, such as "e2e4 e7e5"
+* Description: Plays 'moves' from the starting position, checking each one against the legal moves
+* Return Value: The resulting game, or nullptr if a move couldn't be read or isn't legal
+\*-------------------------------------------------------------------------------------------------------------*/
+static std::shared_ptr<Game> setUpPosition(const char* moves) {
+	std::shared_ptr<Game> game = std::make_shared<Game>();
+	std::istringstream tokens(moves);
+	std::string token;
+	while (tokens >> token) {
+		if (token.size() != 4) return nullptr;
+		uint8_t source = (token[1] - '1') * 8 + (token[0] - 'a');
+		uint8_t target = (token[3] - '1') * 8 + (token[2] - 'a');
+
+		std::vector<Move> legalMoves;
+		game->getAllLegalMoves(&legalMoves, game->whoseTurn());
+		auto move = std::find_if(legalMoves.begin(), legalMoves.end(), [&](const Move& m) {
+			return m.source == source && m.target == target;
+		});
+		if (move == legalMoves.end()) return nullptr;
+		game->makePlayerMove(*move);
+	}
+	return game;
+}
+
+/*-------------------------------------------------------------------------------------------------------------*\
+* benchSignature(std::ostream&)
+*
+* Description: Searches each of the fixed positions for a fixed number of iterations on one thread with the
+*              piece-square evaluator. The total node count only changes when the search itself changes, so it
+*              tells a behavior change apart from a speed change when comparing two builds
+* Return Value: False if the tables couldn't be read or one of the positions couldn't be set up
+\*-------------------------------------------------------------------------------------------------------------*/
+static bool benchSignature(std::ostream& os) {
+	// Material-only evaluation searches a different tree, so its node count would be a different signature
+	PSTEvaluator pst;
+	if (!pst.hasTables()) {
+		os << "Piece-square tables not found at " << DEFAULT_PST_FILE << ", run the benchmark from the repository root\n";
+		return false;
+	}
+	SearchStats total;
+	int index = 0;
+	for (const char* moves : benchPositions) {
+		std::shared_ptr<Game> game = setUpPosition(moves);
+		if (!game) {
+			os << "Bad benchmark position: " << moves << "\n";
+			return false;
+		}
+
+		MMTNode root(game, 0, game->whoseTurn(), &pst);
+		MiniMaxTree tree(&root);
+		tree.search(BENCH_SEARCH_ITERATIONS);
+		total += tree.getStats();
+		os << "Position " << ++index << ": " << tree.getStats().nodes << " nodes\n";
+	}
+
+	os << "===========================\n";
+	os << "Total time (ms):  " << (uint64_t)(total.seconds * 1000) << "\n";
+	os << "Nodes searched:   " << total.nodes << "\n";
+	os << "Nodes/second:     " << (uint64_t)total.nodesPerSecond() << "\n";
+	return true;
+}
+
+int runBenchmark(const char* nnueFile, std::ostream& os) {
+	std::vector<std::shared_ptr<Game>> positions;
+	collectPositions(&positions);
+	os << "Positions:        " << positions.size() << "\n";
+
+	PSTEvaluator pst;
+	if (!pst.hasTables()) {
+		os << "Piece-square tables not found at " << DEFAULT_PST_FILE << ", run the benchmark from the repository root\n";
+		return 1;
+	}
+	benchEvaluator(&pst, positions, os);
+
+	if (nnueFile) {
+		if (!NNUE::load(nnueFile)) {
+			os << "Failed to load network from " << nnueFile << "\n";
+			return 1;
+		}
+		NNUEEvaluator nnue;
+		benchEvaluator(&nnue, positions, os);
+	}
+
+	// Positions set up from their packed form and scored on every hardware thread
+	std::vector<PackedPosition> packed;
+	for (const std::shared_ptr<Game>& position : positions) packed.push_back(position->pack());
+	auto start = std::chrono::steady_clock::now();
+	evaluateBatch(packed.data(), packed.size());
+	std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+	os << "Batch pos/sec:    " << (uint64_t)(packed.size() / elapsed.count()) << "\n";
+
+	// Extra cost of keeping several lines searched instead of just the best one
+	double single = benchSearch(&pst, positions, 1, os);
+	double multi = benchSearch(&pst, positions, BENCH_MULTI_PV, os);
+	if (single > 0) os << "MultiPV cost:     " << multi / single << "x\n";
+
+	return benchSignature(os) ? 0 : 1;
+}
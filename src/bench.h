@@ -0,0 +1,6 @@
+#pragma once
+#include <iostream>
+
+// Runs the engine benchmarks and prints the results. The NNUE evaluator is included when 'nnueFile' is given.
+// Returns the process exit code
+int runBenchmark(const char* nnueFile = nullptr, std::ostream& os = std::cout);
@@ -0,0 +1,66 @@
+#pragma once
+#include <stdint.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+// One bit per square, a1 = bit 0 through h8 = bit 63
+typedef uint64_t Bitboard;
+
+constexpr Bitboard FILE_A_BB = 0x0101010101010101ULL;
+constexpr Bitboard FILE_H_BB = FILE_A_BB << 7;
+constexpr Bitboard RANK_1_BB = 0xFFULL;
+
+inline Bitboard squareBB(int square) { return 1ULL << square; }
+inline Bitboard fileBB(int file) { return FILE_A_BB << file; }
+inline Bitboard rankBB(int rank) { return RANK_1_BB << (8 * rank); }
+
+// The 64-bit MSVC intrinsics only exist on x64, so 32-bit Windows builds work on each half of the board
+inline int popCount(Bitboard b) {
+#if defined(_MSC_VER) && defined(_M_X64)
+	return (int)__popcnt64(b);
+#elif defined(_MSC_VER)
+	return (int)(__popcnt((unsigned int)b) + __popcnt((unsigned int)(b >> 32)));
+#else
+	return __builtin_popcountll(b);
+#endif
+}
+
+// Index of the least significant set bit. 'b' must not be empty
+inline int lsb(Bitboard b) {
+#if defined(_MSC_VER) && defined(_M_X64)
+	unsigned long index;
+	_BitScanForward64(&index, b);
+	return (int)index;
+#elif defined(_MSC_VER)
+	unsigned long index;
+	if (_BitScanForward(&index, (unsigned long)b)) return (int)index;
+	_BitScanForward(&index, (unsigned long)(b >> 32));
+	return (int)index + 32;
+#else
+	return __builtin_ctzll(b);
+#endif
+}
+
+// Index of the most significant set bit. 'b' must not be empty
+inline int msb(Bitboard b) {
+#if defined(_MSC_VER) && defined(_M_X64)
+	unsigned long index;
+	_BitScanReverse64(&index, b);
+	return (int)index;
+#elif defined(_MSC_VER)
+	unsigned long index;
+	if (_BitScanReverse(&index, (unsigned long)(b >> 32))) return (int)index + 32;
+	_BitScanReverse(&index, (unsigned long)b);
+	return (int)index;
+#else
+	return 63 ^ __builtin_clzll(b);
+#endif
+}
+
+// Removes the least significant set bit from 'b' and returns its index
+inline int popLsb(Bitboard& b) {
+	int square = lsb(b);
+	b &= b - 1;
+	return square;
+}
@@ -1,80 +1,51 @@
 #include "board.h"
-#include "piece.h"
-#include "game.h"
-#include "imgui.h"
-#include "gl/glew.h"
+#include "attacks.h"
 #include <cctype>
-#include "VAO.h"
-#include "EBO.h"
-#include "square.h"
+#include <cstring>
 
 const char piece_chars[7] = { ' ', 'P', 'N', 'B', 'R', 'Q', 'K' };
 
+char pieceSymbol(PieceCode piece) {
+	char symbol = piece_chars[typeOf(piece)];
+	return (colorOf(piece) == black) ? (char)tolower(symbol) : symbol;
+}
+
+PieceCode pieceFromSymbol(char symbol) {
+	for (int type = pawn; type <= king; type++) {
+		if (piece_chars[type] == symbol) return makePiece(white, (PieceType)type);
+		if (tolower(piece_chars[type]) == symbol) return makePiece(black, (PieceType)type);
+	}
+	return NO_PIECE;
+}
 
 
 Board::Board() {
-	memset(&board, 0, sizeof(Piece*) * 64);
+	memset(squares, NO_PIECE, sizeof(squares));
+	memset(byType, 0, sizeof(byType));
+	memset(byColor, 0, sizeof(byColor));
 }
 
 
 /*-------------------------------------------------------------------------------------------------------------*\
-* Board::Board(GLuint)
-* 
-* Parameters: fbo - ID of the FrameBuffer Object that the board will be drawn onto
+* Board::startingPosition()
+*
 * Description: Creates a new Board with the classical starting position
 \*-------------------------------------------------------------------------------------------------------------*/
-Board::Board(Game* game) {
- 	memset(&board, 0, sizeof(Piece*) * 64);
-	// Pawns
+Board Board::startingPosition() {
+	Board board;
+	const PieceType backRank[8] = { rook, knight, bishop, queen, king, bishop, knight, rook };
 	for (int file = 0; file < 8; file++) {
-		board[8 + file]  = createPiece<Pawn>(white, 8 + file);
-		board[48 + file] = createPiece<Pawn>(black, 48 + file);
-	}
-
-	// Rooks
-	board[ 0] = createPiece<Rook>(white, 0);
-	board[ 7] = createPiece<Rook>(white, 7);
-	board[56] = createPiece<Rook>(black, 56);
-	board[63] = createPiece<Rook>(black, 63);
-
-	// Knights
-	board[ 1] = createPiece<Knight>(white, 1);
-	board[ 6] = createPiece<Knight>(white, 6);
-	board[57] = createPiece<Knight>(black, 57);
-	board[62] = createPiece<Knight>(black, 62);
-
-	// Bishop
-	board[ 2] = createPiece<Bishop>(white, 2);
-	board[ 5] = createPiece<Bishop>(white, 5);
-	board[58] = createPiece<Bishop>(black, 58);
-	board[61] = createPiece<Bishop>(black, 61);
-
-	// Queens
-	board[ 3] = createPiece<Queen>(white, 3);
-	board[59] = createPiece<Queen>(black, 59);
-
-	// Kings
-	board[ 4] = createPiece<King>(white, 4);
-	board[60] = createPiece<King>(black, 60);
-}
-
-/*-------------------------------------------------------------------------------------------------------------*\
-* Board::Board(Board*)
-* 
-* Parameters: base - Pointer to the board that will be copied
-* Description: Makes a new board which is a copy of 'base'. Used to test moves
-\*-------------------------------------------------------------------------------------------------------------*/
-Board::Board(std::shared_ptr<Board> base) {
-	memset(&board, 0, sizeof(Piece*) * 64);
-	for (int i = 0; i < 64; i++) {
-		if (base->board[i]) board[i] = (base->board[i])->copy();
-		else board[i] = nullptr;
+		board.placePiece(makePiece(white, backRank[file]), file);
+		board.placePiece(makePiece(white, pawn), 8 + file);
+		board.placePiece(makePiece(black, pawn), 48 + file);
+		board.placePiece(makePiece(black, backRank[file]), 56 + file);
 	}
+	return board;
 }
 
 ///*-------------------------------------------------------------------------------------------------------------*\
 //* print_threatmap(uint64_t)
-//* 
+//*
 //* Parameters: map - 64 bit representation of a threatmap
 //* Description: Prints out an 8x8 ASCII representation of a threatmap to the console
 //\*-------------------------------------------------------------------------------------------------------------*/
@@ -93,43 +64,66 @@ Board::Board(std::shared_ptr<Board> base) {
 //	std::cout << "\n";
 //}
 
+// Puts 'piece' on an empty square
+void Board::placePiece(PieceCode piece, int square) {
+	squares[square] = piece;
+	byType[typeOf(piece)] |= squareBB(square);
+	byColor[colorIndex(colorOf(piece))] |= squareBB(square);
+}
+
+void Board::removePiece(int square) {
+	PieceCode piece = squares[square];
+	if (piece == NO_PIECE) return;
+	byType[typeOf(piece)] ^= squareBB(square);
+	byColor[colorIndex(colorOf(piece))] ^= squareBB(square);
+	squares[square] = NO_PIECE;
+}
+
+// Moves the piece on 'source' to 'target', taking whatever was there off the board
+void Board::movePiece(int source, int target) {
+	PieceCode piece = squares[source];
+	removePiece(target);
+	removePiece(source);
+	placePiece(piece, target);
+}
+
 /*-------------------------------------------------------------------------------------------------------------*\
-* Board::makeMove(Piece, int, int)
-* 
-* Parameters: p - Piece that is being moved
-*             s - Index of the source square
-*             d - Index of the destination square
-* Description: Handles moving a piece on the board and checks if we need to promote a pawn
-* Return Value: True if we need to promote a pawn, false otherwise
+* Board::attackersTo(int, Bitboard)
+*
+* Parameters: square - Square being attacked
+*             occupied - Pieces that block sliders, normally pieces() but can differ when looking past a capture
+* Description: Finds the pieces of both colors that attack 'square'
+* Return Value: Bitboard of the attacking pieces
 \*-------------------------------------------------------------------------------------------------------------*/
-bool Board::makeMove(std::shared_ptr<Piece> p, uint8_t s, uint8_t d) {
-	// Make the move
-	placePiece(p, d);
-	clearSquare(s);
-
-	return false;
+Bitboard Board::attackersTo(int square, Bitboard occupied) const {
+	return (pawnAttacks(black, square) & pieces(white, pawn))
+		| (pawnAttacks(white, square) & pieces(black, pawn))
+		| (knightAttacks(square) & byType[knight])
+		| (kingAttacks(square) & byType[king])
+		| (bishopAttacks(square, occupied) & (byType[bishop] | byType[queen]))
+		| (rookAttacks(square, occupied) & (byType[rook] | byType[queen]));
 }
 
-void Board::passantCapture(uint8_t square) {
-	clearSquare(square);
+bool Board::isAttacked(int square, Color by) const {
+	return (attackersTo(square, pieces()) & pieces(by)) != 0;
 }
 
 
 /*-------------------------------------------------------------------------------------------------------------*\
 * Board::printBoard(std::string&)
-* 
+*
 * Description: Outputs a string represention of the current state of the board
 * Return: String representation of the board to be printed
 \*-------------------------------------------------------------------------------------------------------------*/
 std::string Board::printBoardString() const {
-	std::shared_ptr<Piece> p;
+	PieceCode p;
 	char piece_c;
 	std::string s = HORZ_LINE;
 	for (int rank = 7; rank >= 0; rank--) {
 		s += "| ";
 		for (int file = 0; file < 8; file++) {
-			p = getPiece(file, rank);
-			if (p) piece_c = (p->getColor() == white) ? tolower(p->textboardSymbol()) : p->textboardSymbol();
+			p = pieceOn(file, rank);
+			if (p) piece_c = (colorOf(p) == white) ? tolower(piece_chars[typeOf(p)]) : piece_chars[typeOf(p)];
 			else piece_c = ' ';
 			s += piece_c;
 			s += " | ";
@@ -139,35 +133,3 @@ std::string Board::printBoardString() const {
 	}
 	return s;
 }
-
-/*-------------------------------------------------------------------------------------------------------------*\
-* Board::printBoardImage(Shader*)
-* 
-* Description Prints out the graphical representation of the board.
-\*-------------------------------------------------------------------------------------------------------------*/
-
-
-void Board::placePiece(std::shared_ptr<Piece> piece, int file, int rank) {
-	placePiece(piece, rank * 8 + file );
-}
-
-void Board::placePiece(std::shared_ptr<Piece> piece, uint8_t square) {
-	board[square] = piece;
-	if (piece) piece->place(square);
-}
-
-void Board::clearSquare(int file, int rank) {
-	placePiece(nullptr, rank * 8 + file);
-}
-
-void Board::clearSquare(uint8_t s) {
-	placePiece(nullptr, s);
-}
-
-std::shared_ptr<Piece> Board::getPiece(int f, int r) const {
-	return getPiece(r * 8 + f);
-}
-std::shared_ptr<Piece> Board::getPiece(uint8_t s) const {
-	if (s < 64)  return board[s];
-	else return 0;
-}
\ No newline at end of file
@@ -1,42 +1,48 @@
 #pragma once
 
 #include "util.h"
-#include "shader.h"
+#include "bitboard.h"
 #include <string>
 
 
-class Piece;
-class Game;
-class Board;
-enum Castling {	WHITE_SHORT, WHITE_LONG, BLACK_SHORT, BLACK_LONG };
+// A piece as a small code: its PieceType in the low 3 bits, plus 8 when it's black. 0 is an empty square
+typedef uint8_t PieceCode;
+constexpr PieceCode NO_PIECE = 0;
+constexpr PieceCode BLACK_PIECE = 8;
 
+inline PieceCode makePiece(Color color, PieceType type) { return (PieceCode)(type | ((color == black) ? BLACK_PIECE : 0)); }
+inline PieceType typeOf(PieceCode piece) { return (PieceType)(piece & 7); }
+inline Color colorOf(PieceCode piece) { return (piece == NO_PIECE) ? none : (piece & BLACK_PIECE) ? black : white; }
+inline int colorIndex(Color color) { return (color == white) ? 0 : 1; }
 
-template <class T>
-std::shared_ptr<T> createPiece(Color color, uint8_t position) {
-	std::shared_ptr<T> newPiece = std::make_shared<T>(T(color, position));
-	newPiece->createTexture();
-	return newPiece;
-}
+// Letter for a piece as written in FEN: upper case for white, lower case for black, space for an empty square
+char pieceSymbol(PieceCode);
+// The piece written as 'symbol' in FEN, or NO_PIECE if it isn't a piece letter
+PieceCode pieceFromSymbol(char symbol);
 
 class Board {
-	// essential data
-	std::shared_ptr<Piece> board[64];
+	// The same position twice: piece codes by square, and bitboards by type and color. Kept in step on every change
+	PieceCode squares[64];
+	Bitboard byType[7];
+	Bitboard byColor[2];	// indexed white, black
 
 public:
-	Board();
-	Board(Game*); // Creates new starting board
-	Board(std::shared_ptr<Board>); // Copies board state
-
-	void placePiece(std::shared_ptr<Piece>, int, int);
-	void placePiece(std::shared_ptr<Piece>, uint8_t);
-	void clearSquare(int, int);
-	void clearSquare(uint8_t);
-
-	std::shared_ptr<Piece> getPiece(int f, int r) const;
-	std::shared_ptr<Piece> getPiece(uint8_t s) const;
-	bool makeMove(std::shared_ptr<Piece>, uint8_t, uint8_t);
-	void passantCapture(uint8_t);
-	
+	Board(); // Creates an empty board
+	static Board startingPosition();
+
+	PieceCode pieceOn(int square) const { return squares[square]; }
+	PieceCode pieceOn(int file, int rank) const { return squares[rank * 8 + file]; }
+	Bitboard pieces() const { return byColor[0] | byColor[1]; }
+	Bitboard pieces(Color color) const { return byColor[colorIndex(color)]; }
+	Bitboard pieces(PieceType type) const { return byType[type]; }
+	Bitboard pieces(Color color, PieceType type) const { return byColor[colorIndex(color)] & byType[type]; }
+
+	void placePiece(PieceCode, int square);
+	void removePiece(int square);
+	void movePiece(int source, int target);
+
+	Bitboard attackersTo(int square, Bitboard occupied) const;
+	bool isAttacked(int square, Color by) const;
+
 	std::string printBoardString() const;
-	
-};
\ No newline at end of file
+};
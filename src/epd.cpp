@@ -0,0 +1,356 @@
+#include "epd.h"
+#include "MiniMaxTree.h"
+#include "notation.h"
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <thread>
+#include <unordered_map>
+
+// Search iterations run between checks of the limits and of the move being searched
+constexpr uint64_t EPD_SEARCH_CHUNK = 32;
+
+typedef std::chrono::steady_clock Clock;
+
+// Splits the operations after the FEN fields at their semicolons, leaving semicolons inside quotes alone
+static std::vector<std::string> splitOperations(const std::string& text) {
+	std::vector<std::string> operations;
+	std::string current;
+	bool quoted = false;
+	for (char c : text) {
+		if (c == '"') quoted = !quoted;
+		if (c == ';' && !quoted) {
+			operations.push_back(current);
+			current.clear();
+		}
+		else current += c;
+	}
+	if (current.find_first_not_of(" \t\r") != std::string::npos) operations.push_back(current);
+	return operations;
+}
+
+/*-------------------------------------------------------------------------------------------------------------*\
+* parseEPD(const std::string&, EPDPosition&)
+*
+* Parameters: line - Four FEN fields followed by operations, such as: ... w - - bm Qg6; id "WAC.001";
+*             position - Filled in from the line
+* Description: Reads the position and the bm, am and id operations. Other operations are skipped. The moves are
+*              resolved from SAN against the position, so a suite with a mistyped move is caught on loading
+* Return Value: False if the position or one of the moves can't be read, or a bm or am lists no moves
+\*-------------------------------------------------------------------------------------------------------------*/
+bool parseEPD(const std::string& line, EPDPosition& position) {
+	std::istringstream fields(line);
+	std::string field, fen;
+	for (int i = 0; i < 4; i++) {
+		if (!(fields >> field)) return false;
+		fen += (i ? " " : "") + field;
+	}
+	Game game;
+	if (!game.fromFEN(fen)) return false;
+	position.fen = fen;
+
+	std::string rest;
+	std::getline(fields, rest);
+	for (const std::string& operation : splitOperations(rest)) {
+		std::istringstream operands(operation);
+		std::string opcode, operand;
+		if (!(operands >> opcode)) continue;
+
+		if (opcode == "id") {
+			std::getline(operands >> std::ws, operand);
+			while (!operand.empty() && (operand.back() == ' ' || operand.back() == '\r')) operand.pop_back();
+			if (operand.size() >= 2 && operand.front() == '"' && operand.back() == '"') operand = operand.substr(1, operand.size() - 2);
+			position.id = operand;
+		}
+		else if (opcode == "bm" || opcode == "am") {
+			std::vector<Move>& moves = (opcode == "bm") ? position.bestMoves : position.avoidMoves;
+			position.expected += (position.expected.empty() ? "" : "; ") + opcode;
+			size_t before = moves.size();
+			while (operands >> operand) {
+				Move move;
+				if (!parseSAN(game, operand, move)) return false;
+				moves.push_back(move);
+				position.expected += " " + operand;
+			}
+			// A bare "bm;" names no solution at all
+			if (moves.size() == before) return false;
+		}
+	}
+	return true;
+}
+
+// Writes 'text' as a JSON string
+static std::string jsonString(const std::string& text) {
+	std::string json = "\"";
+	for (char c : text) {
+		if (c == '"' || c == '\\') json += '\\';
+		json += c;
+	}
+	return json + "\"";
+}
+
+EPDSuite::EPDSuite(const EPDConfig& config, std::ostream& os) : config(config), os(os) {}
+
+bool EPDSuite::load() {
+	std::ifstream in(config.file);
+	if (!in) {
+		std::cerr << "Failed to open EPD file " << config.file << std::endl;
+		return false;
+	}
+
+	std::string line;
+	for (int number = 1; std::getline(in, line); number++) {
+		if (line.find_first_not_of(" \t\r") == std::string::npos || line[0] == '#') continue;
+		EPDPosition position;
+		if (!parseEPD(line, position)) {
+			std::cerr << "Skipping bad EPD line " << number << ": " << line << std::endl;
+			continue;
+		}
+		// Without bm or am any move would count as solving it
+		if (position.bestMoves.empty() && position.avoidMoves.empty()) {
+			std::cerr << "Skipping EPD line " << number << " with no bm or am: " << line << std::endl;
+			continue;
+		}
+		if (position.id.empty()) position.id = std::to_string(number);
+		positions.push_back(position);
+	}
+
+	if (positions.empty()) {
+		std::cerr << "No positions in " << config.file << std::endl;
+		return false;
+	}
+	return true;
+}
+
+/*-------------------------------------------------------------------------------------------------------------*\
+* EPDSuite::solve(const EPDPosition&, Evaluator*)
+*
+* Parameters: position - Position to search
+*             evaluator - The calling worker's evaluator
+* Description: Searches until the time or node limit, checking the root's best move every few iterations to see
+*              when the search found the solution
+* Return Value: Whether the final move solves the position, and how long and how many nodes it took to settle
+\*-------------------------------------------------------------------------------------------------------------*/
+EPDResult EPDSuite::solve(const EPDPosition& position, Evaluator* evaluator) const {
+	EPDResult result;
+	std::shared_ptr<Game> game = std::make_shared<Game>();
+	game->fromFEN(position.fen);
+	auto solves = [&](const Move& move) {
+		// Positions with only am are solved by any other move; load() drops those with neither
+		bool best = (position.bestMoves.empty()) ? !position.avoidMoves.empty()
+			: std::find(position.bestMoves.begin(), position.bestMoves.end(), move) != position.bestMoves.end();
+		return best && std::find(position.avoidMoves.begin(), position.avoidMoves.end(), move) == position.avoidMoves.end();
+	};
+
+	Clock::time_point start = Clock::now();
+	MMTNode root(game, 0, game->whoseTurn(), evaluator);
+	MiniMaxTree tree(&root);
+	const SearchStats& stats = tree.getStats();
+	uint64_t maxNodes = std::max<uint64_t>(1, ((uint64_t)config.hashMB << 20) / (sizeof(MMTNode) + sizeof(Game) + 128));
+
+	bool solving = false;
+	while (true) {
+		uint64_t before = stats.nodes;
+		tree.search(EPD_SEARCH_CHUNK);
+		int64_t elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(Clock::now() - start).count();
+
+		bool solvedNow = !root.isLeaf() && solves(root.bestMove);
+		if (solvedNow && !solving) {
+			result.solveTime = elapsed;
+			result.solveNodes = stats.nodes;
+		}
+		solving = solvedNow;
+
+		// A chunk that adds no nodes found only mates, stalemates and repetitions, so searching on changes nothing
+		if (stats.nodes == before || stats.nodes >= maxNodes) break;
+		if ((config.nodes) ? stats.nodes >= config.nodes : elapsed >= config.moveTime) break;
+	}
+
+	result.solved = solving;
+	if (!solving) {
+		result.solveTime = -1;
+		result.solveNodes = 0;
+	}
+	if (!root.isLeaf()) result.move = toSAN(*game, root.bestMove);
+	result.nodes = stats.nodes;
+	result.seconds = std::chrono::duration<double>(Clock::now() - start).count();
+	return result;
+}
+
+void EPDSuite::worker() {
+	std::shared_ptr<Evaluator> evaluator = createEvaluator(config.evaluator, config.nnueFile);
+	size_t index;
+	while ((index = next++) < positions.size()) {
+		EPDResult result = solve(positions[index], evaluator.get());
+		results[index] = result;
+
+		std::lock_guard<std::mutex> lock(outputMutex);
+		os << "[" << index + 1 << "/" << positions.size() << "] " << positions[index].id << ": "
+			<< (result.solved ? "solved " : "failed ") << result.move << " (" << positions[index].expected << ")";
+		if (result.solved) os << " in " << result.solveTime << " ms, " << result.solveNodes << " nodes";
+		os << std::endl;
+	}
+}
+
+/*-------------------------------------------------------------------------------------------------------------*\
+* EPDSuite::run()
+*
+* Description: Searches every position on the worker threads, then prints the solved count and the nodes per
+*              second over all threads, writes the JSON results and compares them with an earlier run if asked
+* Return Value: The number of positions solved
+\*-------------------------------------------------------------------------------------------------------------*/
+int EPDSuite::run() {
+	// The network is shared by every evaluator, so load it once before the workers start
+	createEvaluator(config.evaluator, config.nnueFile);
+	results.assign(positions.size(), EPDResult());
+	next = 0;
+
+	int threads = (config.concurrency > 0) ? config.concurrency : (int)std::max(1u, std::thread::hardware_concurrency());
+	threads = std::min(threads, (int)positions.size());
+	os << "Searching " << positions.size() << " positions from " << config.file << " on " << threads << " threads, "
+		<< ((config.nodes) ? std::to_string(config.nodes) + " nodes" : std::to_string(config.moveTime) + " ms") << " each" << std::endl;
+
+	Clock::time_point start = Clock::now();
+	std::vector<std::thread> workers;
+	for (int i = 0; i < threads; i++) workers.emplace_back(&EPDSuite::worker, this);
+	for (std::thread& worker : workers) worker.join();
+	double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+
+	int solved = 0;
+	uint64_t nodes = 0;
+	int64_t solveTime = 0;
+	for (const EPDResult& result : results) {
+		nodes += result.nodes;
+		if (!result.solved) continue;
+		solved++;
+		solveTime += result.solveTime;
+	}
+
+	os << "===========================" << std::endl;
+	os << "Solved:           " << solved << "/" << positions.size() << std::endl;
+	os << "Time to solution: " << solveTime << " ms over the solved positions" << std::endl;
+	os << "Nodes searched:   " << nodes << std::endl;
+	os << "Time (s):         " << seconds << std::endl;
+	os << "Nodes/second:     " << (uint64_t)((seconds > 0) ? nodes / seconds : 0) << std::endl;
+
+	if (!config.jsonFile.empty()) writeJSON();
+	if (!config.compareFile.empty()) compare();
+	return solved;
+}
+
+// One position per line, so compare() can read a run back without a full JSON parser
+void EPDSuite::writeJSON() const {
+	std::ofstream out(config.jsonFile);
+	if (!out) {
+		std::cerr << "Failed to write " << config.jsonFile << std::endl;
+		return;
+	}
+
+	out << "{\"file\":" << jsonString(config.file) << ",\"moveTime\":" << config.moveTime << ",\"nodes\":" << config.nodes
+		<< ",\"positions\":[\n";
+	for (size_t i = 0; i < positions.size(); i++) {
+		const EPDResult& result = results[i];
+		out << "{\"id\":" << jsonString(positions[i].id) << ",\"solved\":" << (result.solved ? "true" : "false")
+			<< ",\"move\":" << jsonString(result.move) << ",\"solveTime\":" << result.solveTime
+			<< ",\"solveNodes\":" << result.solveNodes << ",\"nodes\":" << result.nodes << "}"
+			<< ((i + 1 < positions.size()) ? ",\n" : "\n");
+	}
+	out << "]}\n";
+}
+
+// Reads the number following "key": on a line written by writeJSON()
+static int64_t jsonNumber(const std::string& line, const char* key) {
+	size_t at = line.find(std::string("\"") + key + "\":");
+	return (at == std::string::npos) ? -1 : atoll(line.c_str() + at + strlen(key) + 3);
+}
+
+/*-------------------------------------------------------------------------------------------------------------*\
+* EPDSuite::compare()
+*
+* Description: Reads the results of an earlier run written by writeJSON() and reports the positions that are now
+*              solved or no longer solved, and the change in time to solution over the positions both runs solved
+\*-------------------------------------------------------------------------------------------------------------*/
+void EPDSuite::compare() const {
+	std::ifstream in(config.compareFile);
+	if (!in) {
+		std::cerr << "Failed to open " << config.compareFile << std::endl;
+		return;
+	}
+
+	// Earlier solve time by id, -1 for positions it failed
+	std::unordered_map<std::string, int64_t> earlier;
+	std::string line;
+	while (std::getline(in, line)) {
+		size_t at = line.find("{\"id\":\"");
+		if (at == std::string::npos) continue;
+		std::string id;
+		for (size_t c = at + 7; c < line.size() && line[c] != '"'; c++) {
+			if (line[c] == '\\' && c + 1 < line.size()) c++;
+			id += line[c];
+		}
+		earlier[id] = (line.find("\"solved\":true") != std::string::npos) ? jsonNumber(line, "solveTime") : -1;
+	}
+
+	os << "Compared with " << config.compareFile << ":" << std::endl;
+	int gained = 0, lost = 0, bothSolved = 0, earlierSolved = 0;
+	int64_t time = 0, earlierTime = 0;
+	for (size_t i = 0; i < positions.size(); i++) {
+		auto found = earlier.find(positions[i].id);
+		if (found == earlier.end()) continue;
+		bool was = found->second >= 0;
+		bool is = results[i].solved;
+		earlierSolved += was;
+		if (is && !was) {
+			gained++;
+			os << "  + " << positions[i].id << " now solved in " << results[i].solveTime << " ms" << std::endl;
+		}
+		else if (!is && was) {
+			lost++;
+			os << "  - " << positions[i].id << " no longer solved, played " << results[i].move << std::endl;
+		}
+		else if (is && was) {
+			bothSolved++;
+			time += results[i].solveTime;
+			earlierTime += found->second;
+		}
+	}
+	os << "Solved:           " << earlierSolved + gained - lost << " (was " << earlierSolved << ", +" << gained << " -" << lost << ")" << std::endl;
+	os << "Time to solution: " << time << " ms (was " << earlierTime << " ms) over the " << bothSolved << " positions both solved" << std::endl;
+}
+
+
+int runEPDSuite(int argc, char** argv, std::ostream& os) {
+	EPDConfig config;
+	for (int i = 0; i < argc; i++) {
+		std::string option = argv[i];
+		bool hasValue = i + 1 < argc;
+		if (option == "-time" && hasValue) config.moveTime = std::max(1LL, atoll(argv[++i]));
+		else if (option == "-nodes" && hasValue) config.nodes = strtoull(argv[++i], nullptr, 10);
+		else if (option == "-concurrency" && hasValue) config.concurrency = std::max(1, atoi(argv[++i]));
+		else if (option == "-hash" && hasValue) config.hashMB = std::max(1, atoi(argv[++i]));
+		else if (option == "-eval" && hasValue) config.evaluator = argv[++i];
+		else if (option == "--nnue" && hasValue) {
+			config.evaluator = "nnue";
+			config.nnueFile = argv[++i];
+		}
+		else if (option == "-json" && hasValue) config.jsonFile = argv[++i];
+		else if (option == "-compare" && hasValue) config.compareFile = argv[++i];
+		else if (option[0] != '-' && config.file.empty()) config.file = option;
+		else {
+			std::cerr << "Unknown EPD option: " << option << std::endl;
+			return 1;
+		}
+	}
+	if (config.file.empty()) {
+		std::cerr << "Usage: epd <file> [-time <ms> | -nodes <n>] [-concurrency <n>] [-hash <mb>] [-eval pst|nnue] "
+			"[--nnue <file>] [-json <file>] [-compare <file>]" << std::endl;
+		return 1;
+	}
+
+	EPDSuite suite(config, os);
+	if (!suite.load()) return 1;
+	suite.run();
+	return 0;
+}
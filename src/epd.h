@@ -0,0 +1,73 @@
+#pragma once
+#include "game.h"
+#include "Evaluator.h"
+#include <atomic>
+#include <iostream>
+#include <mutex>
+
+// One test position: the FEN part of an EPD line and the moves its bm and am operations name
+struct EPDPosition {
+	std::string id;					// The id operation, or the line number when there isn't one
+	std::string fen;
+	std::vector<Move> bestMoves;	// Any of these solves it
+	std::vector<Move> avoidMoves;	// None of these may be played
+	std::string expected;			// The bm/am operations as written, for the report
+};
+
+// How one position went
+struct EPDResult {
+	bool solved = false;
+	std::string move;				// Move chosen at the end of the search, in SAN
+	int64_t solveTime = -1;			// Milliseconds until the search settled on a solving move for good, -1 if never
+	uint64_t solveNodes = 0;
+	uint64_t nodes = 0;
+	double seconds = 0.0;
+};
+
+// Settings for a run. A nonzero 'nodes' limits each search instead of 'moveTime'
+struct EPDConfig {
+	std::string file;
+	int64_t moveTime = 1000;		// Milliseconds per position
+	uint64_t nodes = 0;
+	int concurrency = 0;			// Positions searched at once, or 0 for one per hardware thread
+	int hashMB = 64;				// Tree memory allowed per search
+	std::string evaluator = "pst";
+	const char* nnueFile = DEFAULT_NNUE_FILE;
+	std::string jsonFile;			// Where to write this run's results
+	std::string compareFile;		// Results of an earlier run to report changes against
+};
+
+/*-------------------------------------------------------------------------------------------------------------*\
+* EPDSuite
+*
+* Description: Runs a suite of EPD test positions, searching several at once on worker threads. A position is
+*              solved when the move searched to the end is one of its bm moves and none of its am moves. The time
+*              to solution is when the search last switched onto a solving move, so later wavering counts against it
+\*-------------------------------------------------------------------------------------------------------------*/
+class EPDSuite {
+	const EPDConfig config;
+	std::vector<EPDPosition> positions;
+	std::vector<EPDResult> results;
+	std::atomic<size_t> next{ 0 };
+	std::mutex outputMutex;
+	std::ostream& os;
+
+	void worker();
+	EPDResult solve(const EPDPosition&, Evaluator*) const;
+	void writeJSON() const;
+	void compare() const;
+
+public:
+	EPDSuite(const EPDConfig&, std::ostream& os = std::cout);
+
+	// Reads the positions from config.file. Returns false if it can't be read or has none
+	bool load();
+	// Searches every position and prints the results. Returns the number solved
+	int run();
+	const std::vector<EPDResult>& getResults() const { return results; }
+};
+
+// Reads an EPD line. Returns false if the position or one of its bm/am moves can't be read
+bool parseEPD(const std::string& line, EPDPosition&);
+// Runs the suite described on the command line, after 'epd'. Returns the process exit code
+int runEPDSuite(int argc, char** argv, std::ostream& os = std::cout);
@@ -1,644 +1,616 @@
 #include "game.h"
-#include "square.h"
-#include "piece.h"
-#include "Player.h"
-#include "imgui.h"
-#include "Texture.h"
+#include "attacks.h"
 
-#define XTRC_BIT(map, bit) (((map) >> (bit)) & 1ULL)
+// Piece types a pawn can become, best first
+constexpr PieceType promotionTypes[4] = { queen, rook, bishop, knight };
 
-constexpr float SQUARE_SIZE = .25f;
-constexpr uint16_t BOARD_SIZE = 400;
-
-bool operator==(const Move left, const Move right) { return left.piece == right.piece && left.source == right.source && left.target == right.target; }
-
-// Sets a single bit in a 64-bit map to 1
-void static setBit(uint64_t* map, uint8_t bit) {
-	if (bit >= 64) {
-		return;
-	}
-	*map |= (1ULL << bit);
+bool operator==(const Move left, const Move right) {
+	return left.source == right.source && left.target == right.target && left.promotion == right.promotion;
 }
 
 Game::Game() {
-	board = std::make_shared<Board>(Board(this));
+	board = Board::startingPosition();
 	whiteKing = 4;
 	blackKing = 60;
+	pawnKey = calculatePawnKey();
+	positionKey = calculatePositionKey();
 }
 
 Game::Game(Game* base) {
-	board = std::make_shared<Board>(Board(base->board));
+	board = base->board;
 
 	gameStatus = base->gameStatus;
+	playStatus = base->playStatus;
 	whiteKing = base->whiteKing;
 	blackKing = base->blackKing;
-	white_threat_map = base->white_threat_map;
-	black_threat_map = base->black_threat_map;
 	enPassantSquare = base->enPassantSquare;
+	fiftyMoveRule = base->fiftyMoveRule;
+	fullMoveNumber = base->fullMoveNumber;
+	pawnKey = base->pawnKey;
+	positionKey = base->positionKey;
+	keyHistory = base->keyHistory;
+	accumulator = base->accumulator;
 }
 
-Game::Game(std::shared_ptr<Game> base) {
-	board = std::make_shared<Board>(Board(base->board));
+Game::Game(std::shared_ptr<Game> base) : Game(base.get()) {}
 
-	gameStatus = base->gameStatus;
-	whiteKing = base->whiteKing;
-	blackKing = base->blackKing;
-	white_threat_map = base->white_threat_map;
-	black_threat_map = base->black_threat_map;
-	enPassantSquare = base->enPassantSquare;
-}
+/*-------------------------------------------------------------------------------------------------------------*\
+* Game::Game(const PackedPosition&)
+*
+* Parameters: position - Packed position to set up
+* Description: Creates a game directly at 'position' without replaying moves. With no move history, repetitions
+*              aren't known
+\*-------------------------------------------------------------------------------------------------------------*/
+Game::Game(const PackedPosition& position) {
+	whiteKing = blackKing = 0;
 
-int8_t Game::getPlayStatus() const {
-	return gameStatus & PLAY_STATUS;
-}
+	int index = 0;
+	for (int square = 0; square < 64; square++) {
+		if (!((position.occupancy[square / 8] >> (square % 8)) & 1)) continue;
+		uint8_t code = (position.pieces[index / 2] >> (4 * (index % 2))) & 0xF;
+		index++;
 
-void Game::makePlayerMove(Move& move) {
-	if (makeLegalMove(move)) handlePromotion();
-}
+		Color color = (code & PACKED_BLACK_PIECE) ? black : white;
+		PieceType type = (PieceType)(code & ~PACKED_BLACK_PIECE);
+		if (type == open || type > king) continue;
 
-void Game::getAllLegalMoves(std::vector<Move>* moves, Color player) {
-	std::shared_ptr<Piece> nextPiece;
-	for (int i = 0; i < 64; i++) {
-		nextPiece = board->getPiece(i);
-		if (!nextPiece || nextPiece->getColor() != player) continue;
-		if (nextPiece->getColor() == none) std::cerr << nextPiece->getPosition() << std::endl;
-		getLegalPieceMoves(moves, nextPiece);
+		if (type == king) (color == white) ? whiteKing = square : blackKing = square;
+		board.placePiece(makePiece(color, type), square);
 	}
-}
 
-float Game::getMaterialDifference() {
-	float materialDifference = 0.f;
-	std::shared_ptr<Piece> nextPiece;
-	for (int i = 0; i < 64; i++) {
-		nextPiece = board->getPiece(i);
-		if (!nextPiece) continue;
+	gameStatus = position.flags & PACKED_CASTLING_MASK;
+	if (position.flags & PACKED_BLACK_TO_MOVE) gameStatus |= WHOSE_TURN;
+	enPassantSquare = position.enPassant;
+	fiftyMoveRule = position.fiftyMoveRule;
+	pawnKey = calculatePawnKey();
+	positionKey = calculatePositionKey();
+	updateChecks();
+}
 
-		if (instanceof<Pawn>(nextPiece))	materialDifference += 1 * nextPiece->getColor();
-		if (instanceof<Knight>(nextPiece))	materialDifference += 3 * nextPiece->getColor();
-		if (instanceof<Bishop>(nextPiece))	materialDifference += 3 * nextPiece->getColor();
-		if (instanceof<Rook>(nextPiece))	materialDifference += 5 * nextPiece->getColor();
-		if (instanceof<Queen>(nextPiece))	materialDifference += 9 * nextPiece->getColor();
-	}
-	return materialDifference;
-}
-
-bool Game::canCastle(Castling whichCastle) const {
-	bool transitCheck;
-	bool currentCheck;
-	bool spaceClear;
-	switch (whichCastle) {
-	case WHITE_SHORT:
-		spaceClear = !board->getPiece(5) && !board->getPiece(6);
-		transitCheck = XTRC_BIT(black_threat_map, whiteKing + 1);
-		currentCheck = gameStatus & WHITE_CHECK;
-		return (!currentCheck && !transitCheck && spaceClear);
-	case WHITE_LONG:
-		spaceClear = !board->getPiece(1) && !board->getPiece(2) && !board->getPiece(3);
-		transitCheck = XTRC_BIT(black_threat_map, whiteKing - 1);
-		currentCheck = gameStatus & WHITE_CHECK;
-		return (!currentCheck && !transitCheck && spaceClear);
-	case BLACK_SHORT:
-		spaceClear = !board->getPiece(61) && !board->getPiece(62);
-		transitCheck = XTRC_BIT(white_threat_map, blackKing + 1);
-		currentCheck = gameStatus & BLACK_CHECK;
-		return (!currentCheck && !transitCheck && spaceClear);
-	case BLACK_LONG:
-		spaceClear = !board->getPiece(57) && !board->getPiece(58) && !board->getPiece(59);
-		transitCheck = XTRC_BIT(white_threat_map, blackKing - 1);
-		currentCheck = gameStatus & BLACK_CHECK;
-		return (!currentCheck && !transitCheck && spaceClear);
+// Writes the position out in the packed format. The move history isn't kept
+PackedPosition Game::pack() const {
+	PackedPosition position = {};
+	int index = 0;
+	Bitboard occupied = board.pieces();
+	while (occupied) {
+		int square = popLsb(occupied);
+		PieceCode piece = board.pieceOn(square);
+
+		uint8_t code = typeOf(piece) | ((colorOf(piece) == black) ? PACKED_BLACK_PIECE : 0);
+		position.occupancy[square / 8] |= 1 << (square % 8);
+		position.pieces[index / 2] |= code << (4 * (index % 2));
+		// A position can't hold more than 32 pieces, so stop rather than write past the end
+		if (++index == 32) break;
 	}
-	return false;
-}
 
-Color Game::whoseTurn() const {
-	if (gameStatus & WHOSE_TURN) return black;
-	return white;
+	position.flags = gameStatus & PACKED_CASTLING_MASK;
+	if (whoseTurn() == black) position.flags |= PACKED_BLACK_TO_MOVE;
+	position.enPassant = enPassantSquare;
+	position.fiftyMoveRule = fiftyMoveRule;
+	return position;
 }
 
-bool Game::isInCheck(Color c) const {
-	return c == black && (gameStatus & BLACK_CHECK) || c == white && (gameStatus & WHITE_CHECK);
+// Reads an unsigned number at 'c' and moves past it. Returns -1 if there are no digits
+static int readNumber(const char*& c) {
+	if (*c < '0' || *c > '9') return -1;
+	int number = 0;
+	for (; *c >= '0' && *c <= '9'; c++) number = std::min(number * 10 + (*c - '0'), 1 << 20);
+	return number;
 }
 
 /*-------------------------------------------------------------------------------------------------------------*\
-* Game::updateThreatMaps()
+* Game::fromFEN(const std::string&)
 *
-* Description: Sets the threat map for both players. A threat map tells which squares of the board are covered
-*              by a color's pieces and is used in calculating check/checkmate
+* Parameters: fen - Position in Forsyth-Edwards Notation. The two move counters may be left off, as in EPD
+* Description: Sets the game to 'fen' without replaying moves: pieces, side to move, castling rights, en passant
+*              square and move counters. The repetition history starts empty. Reads straight from the characters
+*              so bulk loading stays cheap
+* Return Value: True if 'fen' was a valid position. Otherwise the game is left as it was
 \*-------------------------------------------------------------------------------------------------------------*/
-void Game::updateThreatMaps() {
-	white_threat_map = 0ULL;
-	black_threat_map = 0ULL;
-
-	std::shared_ptr<Piece> piece;
-	uint64_t* threat_map;
- 	for (int i = 0; i < 64; i++) {
-		std::vector<Move> moves;
-		piece = board->getPiece(i);
-		if (!piece) continue;
-
-		threat_map = (piece->getColor() == white) ? &white_threat_map : &black_threat_map;
-		getLegalPieceMoves(&moves, piece, true);
-
-		for (Move move : moves) {
-			setBit(threat_map, move.target);
+bool Game::fromFEN(const std::string& fen) {
+	Board parsed;
+	int kings[2] = { -1, -1 };
+	const char* c = fen.c_str();
+	while (*c == ' ') c++;
+
+	// Piece placement, rank 8 first
+	int rank = 7, file = 0;
+	for (; *c && *c != ' '; c++) {
+		if (*c == '/') {
+			if (file != 8 || rank == 0) return false;
+			rank--;
+			file = 0;
 		}
-	}
-}
-
-bool Game::check4check(Move move, bool calculateThreats) {
-	Game testingGame = Game(std::make_shared<Game>(this));
-	std::shared_ptr<Piece> testingPiece = testingGame.board->getPiece(move.piece->getPosition());
-	Move testingMove = { testingPiece, move.source, move.target };
-	testingGame.makeMove(testingMove);
-	if (!calculateThreats) testingGame.updateChecks();
-	bool inCheck = testingGame.isInCheck(move.piece->getColor());
-	return inCheck;
-}
-
-void Game::getLegalPieceMoves(std::vector<Move>* moves, std::shared_ptr<Piece> piece, bool calculateThreats) {
-	std::vector<Move> possibleMoves;
-	piece->possibleMoves(&possibleMoves, board, calculateThreats);
-	// Add castling if this is a king
-	if (instanceof<King>(piece)) {
-		if (piece->getColor() == white) {
-			if (canCastle(WHITE_SHORT)) {
-				possibleMoves.push_back({ piece, piece->getPosition(), 6 });
-			}
-			if (canCastle(WHITE_LONG)) {
-				possibleMoves.push_back({ piece, piece->getPosition(), 2 });
-			}
+		else if (*c >= '1' && *c <= '8') {
+			file += *c - '0';
+			if (file > 8) return false;
 		}
-		if (piece->getColor() == black) {
-			if (canCastle(BLACK_SHORT)) {
-				possibleMoves.push_back({ piece, piece->getPosition(), 62 });
-			}
-			if (canCastle(BLACK_LONG)) {
-				possibleMoves.push_back({ piece, piece->getPosition(), 58 });
+		else {
+			PieceCode piece = pieceFromSymbol(*c);
+			if (!piece || file > 7) return false;
+			if (typeOf(piece) == pawn && (rank == 0 || rank == 7)) return false;
+			if (typeOf(piece) == king) {
+				int& king = kings[colorIndex(colorOf(piece))];
+				if (king >= 0) return false;
+				king = rank * 8 + file;
 			}
+			parsed.placePiece(piece, rank * 8 + file++);
 		}
 	}
-
-	if (instanceof<Pawn>(piece)) {
-		// Add en passant if this is a pawn
-		uint8_t leftAttack = piece->getPosition() + (piece->getColor() * 8 - 1);
-		uint8_t rightAttack = piece->getPosition() + (piece->getColor() * 8 + 1);
-		if (leftAttack == enPassantSquare || rightAttack == enPassantSquare) {
-			possibleMoves.push_back({ piece, piece->getPosition(), (uint8_t)enPassantSquare });
+	if (rank != 0 || file != 8 || kings[0] < 0 || kings[1] < 0) return false;
+
+	// Side to move
+	while (*c == ' ') c++;
+	if (*c != 'w' && *c != 'b') return false;
+	uint16_t status = (*c++ == 'b') ? WHOSE_TURN : 0;
+
+	// Castling rights
+	while (*c == ' ') c++;
+	if (*c == '-') c++;
+	else for (; *c && *c != ' '; c++) {
+		switch (*c) {
+		case 'K': status |= WHITE_SHORT_CASTLE; break;
+		case 'Q': status |= WHITE_LONG_CASTLE; break;
+		case 'k': status |= BLACK_SHORT_CASTLE; break;
+		case 'q': status |= BLACK_LONG_CASTLE; break;
+		default: return false;
 		}
 	}
 
-	for (Move move : possibleMoves) {
-		if (!check4check(move, calculateThreats)) moves->push_back(move);
+	// En passant target square, on the sixth rank of the side to move
+	int8_t passant = -1;
+	while (*c == ' ') c++;
+	if (*c == '-') c++;
+	else {
+		if (c[0] < 'a' || c[0] > 'h' || c[1] != ((status & WHOSE_TURN) ? '3' : '6')) return false;
+		passant = (c[1] - '1') * 8 + (c[0] - 'a');
+		c += 2;
 	}
-	possibleMoves.clear();
-}
-
-void Game::checkIfGameEnded() {
-	// Look for checkmate/stalemate
-	Color nextPlayer = (whoseTurn() == white) ? black : white;
-	std::vector<Move> nextPlayerMoves;
-	getAllLegalMoves(&nextPlayerMoves, nextPlayer);
-
-	// Check for when no moves are left
-	if (nextPlayerMoves.size() == 0) {
-		// Checkmate
-		if (nextPlayer == white && gameStatus & WHITE_CHECK) {
-			std::cout << "0-1" << std::endl;
-			gameStatus |= BLACK_WIN;
-			return;
-		}
-		else if (nextPlayer == black && gameStatus & BLACK_CHECK) {
-			std::cout << "1-0" << std::endl;
-			gameStatus |= WHITE_WIN;
-			return;
-		}
 
-		// Stalemate
-		else {
-			std::cout << ".5-.5" << std::endl;
-			gameStatus |= DRAW;
-			return;
-		}
-	}
+	// Optional halfmove clock and fullmove number
+	while (*c == ' ') c++;
+	int halfMoves = (*c) ? readNumber(c) : 0;
+	while (*c == ' ') c++;
+	int fullMoves = (*c) ? readNumber(c) : 1;
+	while (*c == ' ') c++;
+	if (halfMoves < 0 || fullMoves < 0 || *c) return false;
+
+	// The side that just moved can't have left its king attacked
+	Color mover = (status & WHOSE_TURN) ? white : black;
+	if (parsed.isAttacked(kings[colorIndex(mover)], (Color)-mover)) return false;
+
+	board = parsed;
+	whiteKing = kings[0];
+	blackKing = kings[1];
+	gameStatus = status;
+	playStatus = UNKNOWN_STATUS;
+	enPassantSquare = passant;
+	fiftyMoveRule = (uint8_t)std::min(halfMoves, 255);
+	fullMoveNumber = (uint16_t)std::max(1, std::min(fullMoves, 0xFFFF));
+	keyHistory.clear();
+	accumulator.computed[0] = accumulator.computed[1] = false;
+	pawnKey = calculatePawnKey();
+	positionKey = calculatePositionKey();
+	updateChecks();
+	return true;
+}
 
-	// Check for insufficient material
-	uint8_t numWhiteKnights = 0;
-	uint8_t numWhiteBishops = 0;
-	uint8_t numBlackKnights = 0;
-	uint8_t numBlackBishops = 0;
-	for (int i = 0; i < 64; i++) {
-		std::shared_ptr<Piece> piece = board->getPiece(i);
-		if (!piece) continue;
-		if (instanceof<Rook>(piece) || instanceof<Queen>(piece) || instanceof<Pawn>(piece)) break;
-		else if (instanceof<Bishop>(piece)) (piece->getColor() == white) ? numWhiteBishops++ : numBlackBishops++;
-		else if (instanceof<Knight>(piece)) (piece->getColor() == white) ? numWhiteKnights++ : numBlackKnights++;
-		if (numWhiteBishops >= 2 || numBlackBishops >= 2) break;
-		if (numWhiteKnights >= 3 || numBlackKnights >= 3) break;
-		if (numWhiteKnights >= 1 && numWhiteBishops >= 1) break;
-		if (numBlackKnights >= 1 && numBlackBishops >= 1) break;
-
-		// All pieces have been checked and insufficient material has been found
-		if (i == 63) {
-			gameStatus |= DRAW;
-			return;
+// Writes the position out in Forsyth-Edwards Notation
+std::string Game::toFEN() const {
+	std::string fen;
+	for (int rank = 7; rank >= 0; rank--) {
+		int empty = 0;
+		for (int file = 0; file < 8; file++) {
+			PieceCode piece = board.pieceOn(file, rank);
+			if (!piece) {
+				empty++;
+				continue;
+			}
+			if (empty) fen += (char)('0' + empty);
+			empty = 0;
+			fen += pieceSymbol(piece);
 		}
+		if (empty) fen += (char)('0' + empty);
+		if (rank) fen += '/';
 	}
 
-	// Draw by fifty move rule
-	if (fiftyMoveRule >= 100) {
-		gameStatus |= DRAW;
-		return;
+	fen += (whoseTurn() == white) ? " w " : " b ";
+	if (gameStatus & WHITE_SHORT_CASTLE) fen += 'K';
+	if (gameStatus & WHITE_LONG_CASTLE) fen += 'Q';
+	if (gameStatus & BLACK_SHORT_CASTLE) fen += 'k';
+	if (gameStatus & BLACK_LONG_CASTLE) fen += 'q';
+	if (!(gameStatus & (WHITE_SHORT_CASTLE | WHITE_LONG_CASTLE | BLACK_SHORT_CASTLE | BLACK_LONG_CASTLE))) fen += '-';
+
+	fen += ' ';
+	if (enPassantSquare < 0) fen += '-';
+	else {
+		fen += (char)('a' + enPassantSquare % 8);
+		fen += (char)('1' + enPassantSquare / 8);
 	}
+	fen += ' ' + std::to_string(fiftyMoveRule) + ' ' + std::to_string(fullMoveNumber);
+	return fen;
+}
+
+/*-------------------------------------------------------------------------------------------------------------*\
+* Game::getPlayStatus()
+*
+* Description: Works out whether the game has ended, by checkmate, stalemate, insufficient material, the fifty
+*              move rule or threefold repetition. Moves don't pay for this: it's only done when asked for and the
+*              answer is kept until the next move. The legal move test stops at the first legal move it finds
+* Return Value: PLAYING, WHITE_WIN, BLACK_WIN or DRAW
+\*-------------------------------------------------------------------------------------------------------------*/
+uint16_t Game::getPlayStatus() const {
+	if (playStatus != UNKNOWN_STATUS) return playStatus;
+
+	Color toMove = whoseTurn();
+	if (!hasLegalMove(toMove)) playStatus = !isInCheck(toMove) ? DRAW : (toMove == white) ? BLACK_WIN : WHITE_WIN;
+	else if (hasInsufficientMaterial() || fiftyMoveRule >= 100 || countRepetitions() >= 2) playStatus = DRAW;
+	else playStatus = PLAYING;
+	return playStatus;
 }
 
+// Plays a move in an actual game. Anything following the game, such as GraphicalGame's record, hooks in here
+void Game::makePlayerMove(const Move& move) {
+	playMove(move);
+}
 
-bool Game::hasLegalMove(Color c) {
-	for (int i = 0; i < 64; i++) {
-		std::shared_ptr<Piece> p = board->getPiece(i % 8, i / 8);
-		if (!p) continue;
-		if (p->getColor() == c) {
-			std::vector<Move> moves;
-			getLegalPieceMoves(&moves, p, false);
-			if (moves.size() != 0) return true;
-		}
+void Game::getAllLegalMoves(std::vector<Move>* moves, Color player, GenType type) const {
+	switch (type) {
+	case CAPTURES:	(player == white) ? generateMoves<white, CAPTURES>(moves) : generateMoves<black, CAPTURES>(moves); break;
+	case QUIETS:	(player == white) ? generateMoves<white, QUIETS>(moves) : generateMoves<black, QUIETS>(moves); break;
+	case EVASIONS:	(player == white) ? generateMoves<white, EVASIONS>(moves) : generateMoves<black, EVASIONS>(moves); break;
+	default:		(player == white) ? generateMoves<white, LEGAL>(moves) : generateMoves<black, LEGAL>(moves); break;
 	}
-	return false;
 }
 
-void Game::updateChecks() {
-	// Look for check
-	gameStatus &= ~(WHITE_CHECK | BLACK_CHECK);
-	updateThreatMaps();
-	if (XTRC_BIT(white_threat_map, blackKing)) gameStatus |= BLACK_CHECK;
-	if (XTRC_BIT(black_threat_map, whiteKing)) gameStatus |= WHITE_CHECK;
+// Legal moves of the piece standing on 'square'
+void Game::getLegalPieceMoves(std::vector<Move>* moves, uint8_t square) const {
+	std::vector<Move> all;
+	getAllLegalMoves(&all, colorOf(board.pieceOn(square)));
+	for (const Move& move : all) {
+		if (move.source == square) moves->push_back(move);
+	}
 }
 
 /*-------------------------------------------------------------------------------------------------------------*\
-* Game::makeLegalMove(Piece, int, int)
+* Game::visitLegalMoves<Us, Type, Visit>(Visit&&)
 *
-* Parameters: p - Piece that is moving
-*             src - Index of the square FROM which the Piece is moving
-*             dest - Index of the square TO which the Piece is moving
-* Description: Makes the move on the board and accordingly updates the game state, such as castling availablity,
-*              en passant opportunities, whose turn, etc.
+* Parameters: visit - Called with each legal move. Returning true stops the generation
+* Description: Finds the legal moves of type 'Type' for color 'Us'. Targets come straight from the attack tables
+*              and each move is then checked for leaving our king attacked. A pawn reaching the last rank gives
+*              one move per promotion piece; pushes count as quiets and captures as captures
+* Return Value: True if 'visit' stopped the generation early
 \*-------------------------------------------------------------------------------------------------------------*/
-bool Game::makeLegalMove(Move move) {
-	bool updatePassant = false;
-
-	fiftyMoveRule++;
-
-	// Enforce castling restrictions
-	if (instanceof<King>(move.piece)) {
-		if (move.piece->getColor() == white) {
-			gameStatus &= ~(WHITE_SHORT_CASTLE | WHITE_LONG_CASTLE);
-		}
-		if (move.piece->getColor() == black) {
-			gameStatus &= ~(BLACK_SHORT_CASTLE | BLACK_LONG_CASTLE);
-		}
-	}
-	else if (instanceof<Rook>(move.piece)) {
-		if (move.piece->getColor() == white) {
-			if (move.source == 7) gameStatus &= ~WHITE_SHORT_CASTLE;
-			if (move.source == 0) gameStatus &= ~WHITE_LONG_CASTLE;
+template<Color Us, GenType Type, typename Visit>
+bool Game::visitLegalMoves(Visit&& visit) const {
+	typedef Side<Us> S;
+	const Bitboard ours = board.pieces(Us);
+	const Bitboard theirs = board.pieces(S::them);
+	const Bitboard occupied = ours | theirs;
+	const Bitboard targets = (Type == CAPTURES) ? theirs : (Type == QUIETS) ? ~occupied : ~ours;
+
+	auto add = [&](int source, int target, PieceType promotion) {
+		Move move(board.pieceOn(source), (uint8_t)source, (uint8_t)target, promotion);
+		return isLegal<Us>(move) && visit(move);
+	};
+	auto addPawnMove = [&](int source, int target) {
+		if (target / 8 != S::promotionRank) return add(source, target, open);
+		for (PieceType type : promotionTypes) {
+			if (add(source, target, type)) return true;
 		}
-		if (move.piece->getColor() == black) {
-			if (move.source == 63) gameStatus &= ~BLACK_SHORT_CASTLE;
-			if (move.source == 56) gameStatus &= ~BLACK_LONG_CASTLE;
+		return false;
+	};
+
+	Bitboard pawns = board.pieces(Us, pawn);
+	while (pawns) {
+		int square = popLsb(pawns);
+		int push = square + S::forward;
+		if (Type != CAPTURES && !(occupied & squareBB(push))) {
+			if (addPawnMove(square, push)) return true;
+			if (square / 8 == S::pawnRank && !(occupied & squareBB(push + S::forward)) && add(square, push + S::forward, open)) return true;
 		}
-	}
-	else if (instanceof<Pawn>(move.piece)) {
-		fiftyMoveRule = 0;
-		updatePassant = true;
-		std::static_pointer_cast<Pawn>(move.piece)->losePower();
-		if (move.target == enPassantSquare) {
-			board->passantCapture(enPassantSquare - move.piece->getColor() * 8);
+		if (Type != QUIETS) {
+			Bitboard captures = pawnAttacks(Us, square) & theirs;
+			while (captures) {
+				if (addPawnMove(square, popLsb(captures))) return true;
+			}
+			if (enPassantSquare >= 0 && (pawnAttacks(Us, square) & squareBB(enPassantSquare)) && add(square, enPassantSquare, open)) return true;
 		}
 	}
 
-	enPassantSquare = -1;
-
-	// Check if en passant is available for next move
-	if (updatePassant) {
-		int dist = abs(move.target / 8 - move.source / 8);
-		int enPassantTarget = move.target - (move.piece->getColor() * 8);
-		if (dist == 2) enPassantSquare = enPassantTarget;
-	}
-
-	char sourceFile = 'a' + move.source % 8;
-	char sourceRank = '1' + move.source / 8;
-	char targetFile = 'a' + move.target % 8;
-	char targetRank = '1' + move.target / 8;
-	bool captureOccured = board->getPiece(move.target) != 0;
-	std::string moveString = "";
-	if (whoseTurn() == white) moveString += std::to_string(moveList.size() / 2 + 1) + ". ";
-	if (!instanceof<Pawn>(move.piece)) moveString += move.piece->textboardSymbol();
-	else if (captureOccured) moveString += 'a' + move.source % 8;
-	if (captureOccured) {
-		moveString += "x";
-		fiftyMoveRule = 0;
-	}
-	moveString += targetFile;
-	moveString += targetRank;
-	moveList.push_back(moveString);
-
-	if (makeMove(move)) {
-		handlePromotion();
-		return true;
+	for (PieceType type : { knight, bishop, rook, queen, king }) {
+		Bitboard pieces = board.pieces(Us, type);
+		while (pieces) {
+			int square = popLsb(pieces);
+			Bitboard attacks = (type == knight) ? knightAttacks(square)
+				: (type == bishop) ? bishopAttacks(square, occupied)
+				: (type == rook) ? rookAttacks(square, occupied)
+				: (type == queen) ? bishopAttacks(square, occupied) | rookAttacks(square, occupied)
+				: kingAttacks(square);
+			attacks &= targets;
+			while (attacks) {
+				if (add(square, popLsb(attacks), open)) return true;
+			}
+		}
 	}
 
-	
-	updateChecks();
-	if ((gameStatus & WHITE_CHECK && whoseTurn() == black) || (gameStatus & BLACK_CHECK && whoseTurn() == white)) moveList[moveList.size() - 1] += "+";
-
-
-	checkIfGameEnded();
-	if (((gameStatus & PLAY_STATUS) == WHITE_WIN) || ((gameStatus & PLAY_STATUS) == BLACK_WIN)) {
-		moveList[moveList.size() - 1].pop_back();
-		moveList[moveList.size() - 1] += "#";
+	if (Type != CAPTURES) {
+		if (canCastle<Us, true>() && add(S::kingStart, S::kingStart + 2, open)) return true;
+		if (canCastle<Us, false>() && add(S::kingStart, S::kingStart - 2, open)) return true;
 	}
-
-	// Other player's turn
-	gameStatus ^= WHOSE_TURN;
 	return false;
 }
 
-bool Game::makeMove(Move move) {
-	if (!move.piece) return false;
-	// Clear old spot
-	board->makeMove(move.piece, move.source, move.target);
+template<Color Us, GenType Type>
+void Game::generateMoves(std::vector<Move>* moves) const {
+	visitLegalMoves<Us, Type>([moves](const Move& move) {
+		moves->push_back(move);
+		return false;
+	});
+}
 
-	// Extra move on castle
-	if (instanceof<King>(move.piece)) {
-		uint8_t targetFile = move.target % 8;
-		uint8_t sourceFile = move.source % 8;
-		if (move.piece->getColor() == white) {
-			whiteKing = move.target;
-			if (targetFile == 6 && abs(sourceFile - targetFile) == 2) {
-				board->makeMove(board->getPiece(7, 0), 7, 5);
-			}
-			if (targetFile == 2 && abs(sourceFile - targetFile) == 2) {
-				board->makeMove(board->getPiece(0, 0), 0, 3);
-			}
-		}
-		if (move.piece->getColor() == black) {
-			blackKing = move.target;
-			if (targetFile == 6 && abs(sourceFile - targetFile) == 2) {
-				board->makeMove(board->getPiece(7, 7), 63, 61);
+// Plays the move on a copy of the board and checks our king isn't left attacked
+template<Color Us>
+bool Game::isLegal(const Move& move) const {
+	Board after = board;
+	if (typeOf(move.piece) == pawn && move.target == enPassantSquare) after.removePiece(move.target - Side<Us>::forward);
+	after.movePiece(move.source, move.target);
+	int kingSquare = (typeOf(move.piece) == king) ? move.target : (Us == white) ? whiteKing : blackKing;
+	return !after.isAttacked(kingSquare, Side<Us>::them);
+}
 
-			}
-			if (targetFile == 2 && abs(sourceFile - targetFile) == 2) {
-				board->makeMove(board->getPiece(0, 7), 56, 59);
-			}
-		}
+// Hashes the pawns from scratch. Moves keep 'pawnKey' up to date incrementally
+uint64_t Game::calculatePawnKey() const {
+	uint64_t key = 0;
+	for (Color color : { white, black }) {
+		Bitboard pawns = board.pieces(color, pawn);
+		while (pawns) key ^= pieceKey(color, pawn, popLsb(pawns));
 	}
+	return key;
+}
 
-	// Check for promotion
-	int promotion_sqr = (move.piece->getColor() == white) ? 7 : 0;
-	if (instanceof<Pawn>(move.piece) && (move.target / 8 == promotion_sqr)) {
-		promotionSubject = move.target;
-		return 1;
+// Hashes the whole position from scratch. Moves keep 'positionKey' up to date incrementally
+uint64_t Game::calculatePositionKey() const {
+	uint64_t key = stateKey();
+	Bitboard occupied = board.pieces();
+	while (occupied) {
+		int square = popLsb(occupied);
+		PieceCode piece = board.pieceOn(square);
+		key ^= pieceKey(colorOf(piece), typeOf(piece), square);
 	}
-	return 0;
+	return key;
 }
 
-void Game::handlePromotion() {
-	gameStatus |= PROMOTING;
+// Part of the position key that isn't pieces: castling rights, en passant file and side to move. The en passant
+// file only counts when a pawn could take there, so a double push nobody can answer doesn't hide a repetition
+uint64_t Game::stateKey() const {
+	uint64_t key = zobrist().castling[gameStatus & (WHITE_SHORT_CASTLE | WHITE_LONG_CASTLE | BLACK_SHORT_CASTLE | BLACK_LONG_CASTLE)];
+	if (enPassantSquare >= 0 && (pawnAttacks((Color)-whoseTurn(), enPassantSquare) & board.pieces(whoseTurn(), pawn))) {
+		key ^= zobrist().enPassant[enPassantSquare % 8];
+	}
+	if (whoseTurn() == black) key ^= zobrist().blackToMove;
+	return key;
 }
 
-GraphicalGame::GraphicalGame(unsigned int fbo) : Game(), fbo(fbo) {
-	glGenTextures(1, &boardGraphic);
-	glBindTexture(GL_TEXTURE_2D, boardGraphic);
-	glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, WIN_WIDTH, WIN_HEIGHT, 0, GL_RGB, GL_UNSIGNED_BYTE, NULL);
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-	glBindTexture(GL_TEXTURE_2D, 0);
-
-
-	unsigned int render_buffer_object;
-	glGenRenderbuffers(1, &render_buffer_object);
-	glBindRenderbuffer(GL_RENDERBUFFER, render_buffer_object);
-	glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH24_STENCIL8, WIN_WIDTH, WIN_HEIGHT);
-	glBindRenderbuffer(GL_RENDERBUFFER, 0);
-
-	// attaching render buffer 
-	glBindFramebuffer(GL_DRAW_FRAMEBUFFER, fbo);
-	glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, boardGraphic, 0);
-	glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_RENDERBUFFER, render_buffer_object);
-
-	if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
-		std::cout << "Frame buffer failed.\n" << std::endl;
-
-	glBindFramebuffer(GL_FRAMEBUFFER, 0);
-
-	colorShader = new Shader("res/shaders/default.vert", "res/shaders/default.frag");
-	pieceShader = new Shader("res/shaders/piece.vert", "res/shaders/piece.frag");
+/*-------------------------------------------------------------------------------------------------------------*\
+* Game::countRepetitions()
+*
+* Description: Looks back through the earlier positions for the current one. Only positions since the last
+*              capture or pawn move can match, and only every other one has the same side to move, so the scan
+*              starts four plies back and steps two plies at a time
+* Return Value: Number of earlier occurrences of the current position
+\*-------------------------------------------------------------------------------------------------------------*/
+int Game::countRepetitions() const {
+	int window = std::min((int)keyHistory.size(), (int)fiftyMoveRule);
+	int count = 0;
+	for (int distance = 4; distance <= window; distance += 2) {
+		if (keyHistory[keyHistory.size() - distance] == positionKey) count++;
+	}
+	return count;
 }
 
-GraphicalGame::~GraphicalGame() {
-	if (colorShader) delete colorShader;
-	if (pieceShader) delete pieceShader;
-	deletePromotionTextures();
+// A piece appeared on or left 'square': keeps the position key and the NNUE accumulator in step
+void Game::updatePiece(Color color, PieceType type, uint8_t square, bool added) {
+	positionKey ^= pieceKey(color, type, square);
+	updateAccumulator(color, type, square, added);
 }
 
-void GraphicalGame::createPromotionTextures() {
-	queenPromotion = new Texture(&Queen(whoseTurn(), 0));
-	rookPromotion = new Texture(&Rook(whoseTurn(), 0));
-	knightPromotion = new Texture(&Knight(whoseTurn(), 0));
-	bishopPromotion = new Texture(&Bishop(whoseTurn(), 0));
+// Keeps the NNUE accumulator in step with a piece appearing on or leaving a square
+void Game::updateAccumulator(Color color, PieceType type, uint8_t square, bool added) {
+	// Every feature on a side depends on where its king is, so a king move means starting that side over
+	if (type == king) {
+		accumulator.computed[(color == white) ? 0 : 1] = false;
+		return;
+	}
+	if (accumulator.computed[0]) NNUE::updateFeature(accumulator, 0, whiteKing, color, type, square, added);
+	if (accumulator.computed[1]) NNUE::updateFeature(accumulator, 1, blackKing, color, type, square, added);
 }
 
-void GraphicalGame::deletePromotionTextures() {
-	if (queenPromotion) delete queenPromotion; 
-	if (rookPromotion) delete rookPromotion;
-	if (knightPromotion) delete knightPromotion;
-	if (bishopPromotion) delete bishopPromotion;
-
-	queenPromotion = rookPromotion = knightPromotion = bishopPromotion = 0;
+// Refreshes whichever halves of the accumulator are out of date. Only valid while a network is loaded
+const Accumulator& Game::getAccumulator() const {
+	if (!accumulator.computed[0]) NNUE::refresh(accumulator, 0, board, whiteKing);
+	if (!accumulator.computed[1]) NNUE::refresh(accumulator, 1, board, blackKing);
+	return accumulator;
 }
 
-void GraphicalGame::grab(std::shared_ptr<Piece> p) {
-	held = p;
-	p->select();
+/*-------------------------------------------------------------------------------------------------------------*\
+* Game::canCastle<Us, KingSide>()
+*
+* Description: Checks the castling right is still held, the king and rook are on their starting squares, the
+*              squares between them are empty and the king isn't in or passing through check. Whether the king
+*              lands in check is left to the usual legality test
+\*-------------------------------------------------------------------------------------------------------------*/
+template<Color Us, bool KingSide>
+bool Game::canCastle() const {
+	typedef Side<Us> S;
+	constexpr uint16_t right = KingSide ? S::shortCastle : S::longCastle;
+	constexpr uint8_t rookSquare = KingSide ? S::shortRook : S::longRook;
+	constexpr int step = KingSide ? 1 : -1;
+
+	if (!(gameStatus & right) || (gameStatus & S::check)) return false;
+	if (board.pieceOn(S::kingStart) != makePiece(Us, king)) return false;
+	if (board.pieceOn(rookSquare) != makePiece(Us, rook)) return false;
+
+	for (int square = S::kingStart + step; square != rookSquare; square += step) {
+		if (board.pieceOn(square)) return false;
+	}
+	return !board.isAttacked(S::kingStart + step, S::them);
 }
 
-std::shared_ptr<Piece> GraphicalGame::drop() {
-	std::shared_ptr<Piece> returnPiece = held;
-	held->deselect();
-	held = nullptr;
-	return returnPiece;
+Color Game::whoseTurn() const {
+	if (gameStatus & WHOSE_TURN) return black;
+	return white;
 }
 
-void GraphicalGame::handlePromotion() {
-	Game::handlePromotion();
-	createPromotionTextures();
+bool Game::isInCheck(Color c) const {
+	return c == black && (gameStatus & BLACK_CHECK) || c == white && (gameStatus & WHITE_CHECK);
 }
 
+// No pawns, rooks or queens, and neither side with a bishop pair, three knights or a bishop and a knight. The
+// piece bitboards answer this directly, and almost always at the first test
+bool Game::hasInsufficientMaterial() const {
+	if (board.pieces(pawn) | board.pieces(rook) | board.pieces(queen)) return false;
+	for (Color color : { white, black }) {
+		int bishops = popCount(board.pieces(color, bishop));
+		int knights = popCount(board.pieces(color, knight));
+		if (bishops >= 2 || knights >= 3 || (bishops >= 1 && knights >= 1)) return false;
+	}
+	return true;
+}
 
-#define FIX_BOARD_POSITION
-void GraphicalGame::printBoardImage() {
-	glBindFramebuffer(GL_DRAW_FRAMEBUFFER, fbo);
-	glEnable(GL_DEPTH_TEST);
-	glClearColor(0.f, 0.f, 0.f, 1.f);
-	glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
-
-	ImGui::PushStyleVar(ImGuiStyleVar_WindowPadding, { 0,0 });
-#ifdef FIX_BOARD_POSITION
-	ImGui::SetNextWindowPos(ImVec2(WIN_WIDTH - BOARD_SIZE, 0));
-	ImGui::SetNextWindowSize(ImVec2(BOARD_SIZE, BOARD_SIZE));
-#endif
-	if (ImGui::Begin("Gameview", 0, ImGuiWindowFlags_NoTitleBar | ImGuiWindowFlags_NoScrollbar)) {		//ImGui::SetCursorPos({0, 0})
-		glm::vec3 topLeft;
-		std::shared_ptr<Piece> p;
-		for (int i = 0; i < 64; i++) {
-			float left = (i % 8 - 4) * .25f;
-			float top = (float)(i / -8 + 4) * .25f;
-			topLeft = glm::vec3(left, top, 0);
-			bool isLightSquare = (i % 2) ^ (i / 8 % 2);
-			p = board->getPiece(i);
-			Square s = Square(topLeft, isLightSquare, p);
-			s.draw(colorShader);
-
-			if (p && !p->isSelected()) {
-				s.drawTexture(pieceShader);
-			}
-		}
-		if (held) {
-			ImVec2 mPos = ImGui::GetMousePos();
-			topLeft.x = (mPos.x - (WIN_WIDTH - BOARD_SIZE)) / BOARD_SIZE * 2 - SQUARE_SIZE / 2 - 1;
-			topLeft.y = mPos.y / BOARD_SIZE * 2 + SQUARE_SIZE / 2 - 1;
-			topLeft.z = -.1f;
-			p = held;
-			Square s = Square(topLeft, 0, p);
-			s.drawTexture(pieceShader);
-		}
-
-		glBindFramebuffer(GL_DRAW_FRAMEBUFFER, 0);
-		glDisable(GL_DEPTH_TEST);
-		glClearColor(0.f, 0.f, 0.f, 1.f);
-		glClear(GL_COLOR_BUFFER_BIT);
+// Stops at the first legal move, so most positions are settled after a single legality test
+bool Game::hasLegalMove(Color c) const {
+	auto found = [](const Move&) { return true; };
+	return (c == white) ? visitLegalMoves<white, LEGAL>(found) : visitLegalMoves<black, LEGAL>(found);
+}
 
-		ImGui::Image((void*)(intptr_t)boardGraphic, ImGui::GetContentRegionAvail());
-	}
-	ImGui::PopStyleVar();
-	ImGui::End();
-}
-
-
-void GraphicalGame::printMoveList() {
-	if (ImGui::Begin("Move List")) {
-		if (ImGui::BeginListBox("##", { 200, 300 })) {
-			ImGui::Selectable("Starting Position", false);
-			if (ImGui::BeginTable("Move List", 2, ImGuiTableFlags_Borders, ImVec2(190.f, 0.f))) {
-				int i = 1;
-				for (std::string move : moveList) {
-					ImGui::TableNextColumn();
-					ImGui::Selectable(move.c_str(), false);
-					i++;
-				}
-			}
-			ImGui::EndTable();
-			if ((gameStatus & PLAY_STATUS) == WHITE_WIN) ImGui::Text("1-0");
-			if ((gameStatus & PLAY_STATUS) == BLACK_WIN) ImGui::Text("0-1");
-			if ((gameStatus & PLAY_STATUS) == DRAW)		 ImGui::Text(".5-.5");
-		}
-		ImGui::EndListBox();
-	}
-	ImGui::End();
+void Game::updateChecks() {
+	// Look for check
+	gameStatus &= ~(WHITE_CHECK | BLACK_CHECK);
+	if (board.isAttacked(blackKing, white)) gameStatus |= BLACK_CHECK;
+	if (board.isAttacked(whiteKing, black)) gameStatus |= WHITE_CHECK;
 }
 
 /*-------------------------------------------------------------------------------------------------------------*\
-* GraphicalGame::render()
-* 
-* Description: Sets up the ImGUI context of our game, handles user entered moves, and handles pawn promotion
+* Game::playMove(const Move&)
+*
+* Parameters: move - Legal move for the side to move
+* Description: Makes the move on the board and accordingly updates the game state, such as castling availablity,
+*              en passant opportunities, whose turn, the position keys, etc. Nothing is written down and the game
+*              isn't checked for having ended, so the search can afford this at every node. getPlayStatus() does
+*              that when asked, and GameRecord keeps the notation of moves in an actual game
 \*-------------------------------------------------------------------------------------------------------------*/
-void GraphicalGame::render() {
-	printBoardImage();
-	printMoveList();
+void Game::playMove(const Move& move) {
+	Color us = colorOf(move.piece);
+	PieceType type = typeOf(move.piece);
 
-	ImGui::Begin("Gameview");
-	ImGuiIO& io = ImGui::GetIO();
+	// Castling rights, en passant and side to move are hashed back in once the move is done
+	keyHistory.push_back(positionKey);
+	positionKey ^= stateKey();
+	fiftyMoveRule++;
+	if (type == pawn || board.pieceOn(move.target)) fiftyMoveRule = 0;
 
-	if ((gameStatus & PLAY_STATUS) != PLAYING) {
-		ImGui::End();
-		return;
+	// Enforce castling restrictions
+	if (us == white) updateCastlingRights<white>(move);
+	else updateCastlingRights<black>(move);
+
+	// A pawn moving onto the en passant square takes the pawn that just passed it
+	if (type == pawn && move.target == enPassantSquare) {
+		int8_t passantCapture = enPassantSquare - us * 8;
+		pawnKey ^= pieceKey((Color)-us, pawn, passantCapture);
+		updatePiece((Color)-us, pawn, passantCapture, false);
+		board.removePiece(passantCapture);
 	}
-	
-	(whoseTurn() == white) ? whitePlayer->itsMyTurn() : blackPlayer->itsMyTurn();
 
-	if (isWaitingOnPromotion()) {
-		PieceType promotionPiece = open;
-		ImGui::Begin("Promotion Selection", 0, ImGuiWindowFlags_NoTitleBar);
+	// Check if en passant is available for next move
+	enPassantSquare = -1;
+	if (type == pawn && abs(move.target - move.source) == 16) enPassantSquare = move.target - us * 8;
 
-		if (ImGui::ImageButton("Queen", queenPromotion->getTextureData(), ImVec2(70, 70))) {
-			promotionPiece = queen;
-		}
-		ImGui::SameLine();
-		if (ImGui::ImageButton("Rook", rookPromotion->getTextureData(), ImVec2(70, 70))) {
-			promotionPiece = rook;
-		}
+	if (movePieces(move)) replacePromotedPawn(move.target, (move.promotion != open) ? move.promotion : queen);
+	updateChecks();
+	playStatus = UNKNOWN_STATUS;
 
-		if (ImGui::ImageButton("Knight", knightPromotion->getTextureData(), ImVec2(70, 70))) {
-			promotionPiece = knight;
-		}
-		ImGui::SameLine();
-		if (ImGui::ImageButton("Bishop", bishopPromotion->getTextureData(), ImVec2(70, 70))) {
-			promotionPiece = bishop;
-		}
+	// Other player's turn
+	if (us == black) fullMoveNumber++;
+	gameStatus ^= WHOSE_TURN;
+	positionKey ^= stateKey();
 
-		switch (promotionPiece) {
-		case queen:
-			promote<Queen>();
-			break;
-		case rook:
-			promote<Rook>();
-			break;
-		case knight:
-			promote<Knight>();
-			break;
-		case bishop:
-			promote<Bishop>();
-			break;
-		}
+	// Earlier positions can't come back after a capture or pawn move
+	if (fiftyMoveRule == 0) keyHistory.clear();
+}
 
-		ImGui::End();
+// Moves the piece, and the rook too when castling, keeping the hashes and the accumulator in step. Returns true
+// if a pawn reached the last rank
+bool Game::movePieces(const Move& move) {
+	if (!move.piece) return false;
+	Color us = colorOf(move.piece);
+	PieceType type = typeOf(move.piece);
+
+	// Keep the pawn hash in step with captured and moving pawns
+	PieceCode captured = board.pieceOn(move.target);
+	if (typeOf(captured) == pawn) pawnKey ^= pieceKey(colorOf(captured), pawn, move.target);
+	if (type == pawn) {
+		pawnKey ^= pieceKey(us, pawn, move.source);
+		pawnKey ^= pieceKey(us, pawn, move.target);
 	}
 
-	else if (ImGui::IsMouseDown(0) && ImGui::IsWindowHovered() && !isHolding()) {
-		ImVec2 wPos  = ImGui::GetWindowPos();
-		ImVec2 wSize = ImGui::GetWindowSize();
-		ImVec2 mPos  = { io.MousePos.x - wPos.x, io.MousePos.y - wPos.y };
-		char file    = (char)(mPos.x / (wSize.x / 8));
-		char rank    = (char)(8 - mPos.y / (wSize.y / 8));
-		std::shared_ptr<Piece> p     = board->getPiece(rank * 8 + file);
-		if (p && p->getColor() == whoseTurn() && !isWaitingOnPromotion()) {
-			grab(p);
+	if (captured) updatePiece(colorOf(captured), typeOf(captured), move.target, false);
+	updatePiece(us, type, move.source, false);
+	updatePiece(us, type, move.target, true);
+
+	board.movePiece(move.source, move.target);
+
+	// Extra move on castle
+	if (type == king) {
+		if (us == white) {
+			whiteKing = move.target;
+			moveCastlingRook<white>(move);
 		}
-	} 
-
-	else if (ImGui::IsMouseReleased(0) && isHolding()) {
-		ImVec2 wPos			= ImGui::GetWindowPos();
-		ImVec2 wSize		= ImGui::GetWindowSize();
-		ImVec2 mPos			= { io.MousePos.x - wPos.x, io.MousePos.y - wPos.y };
-		char file			= (char)(mPos.x / (wSize.x / 8));
-		char rank			= (char)(8 - mPos.y / (wSize.y / 8));
-		std::shared_ptr<Piece> targetPiece	= board->getPiece(rank * 8 + file);
-		std::shared_ptr<Piece> movedPiece	= drop();
-		if (movedPiece) {
-			std::vector<Move> legals;
-			getLegalPieceMoves(&legals, movedPiece, false);
-			Move attempt = { movedPiece, movedPiece->getPosition(), (uint8_t)(rank * 8 + file) };
-			if (std::find(legals.begin(), legals.end(), attempt) != legals.end()) {
-				if (makeLegalMove(attempt)) handlePromotion();
-			}
+		else {
+			blackKing = move.target;
+			moveCastlingRook<black>(move);
 		}
 	}
-	ImGui::End();
+
+	// Check for promotion
+	int promotion_sqr = (us == white) ? 7 : 0;
+	return type == pawn && (move.target / 8 == promotion_sqr);
 }
 
-void GraphicalGame::addPlayer(Player* player, Color color) {
-	if (color == white) whitePlayer = player;
-	else blackPlayer = player;
+// A king or rook leaving its square gives up castling on that side, and so does losing a rook in its corner
+template<Color Us>
+void Game::updateCastlingRights(const Move& move) {
+	typedef Side<Us> S;
+	typedef Side<S::them> Them;
+	if (typeOf(move.piece) == king) gameStatus &= ~(S::shortCastle | S::longCastle);
+	else if (typeOf(move.piece) == rook) {
+		if (move.source == S::shortRook) gameStatus &= ~S::shortCastle;
+		if (move.source == S::longRook) gameStatus &= ~S::longCastle;
+	}
+	if (move.target == Them::shortRook) gameStatus &= ~Them::shortCastle;
+	if (move.target == Them::longRook) gameStatus &= ~Them::longCastle;
 }
 
+// Moves the rook across when the king has just castled
+template<Color Us>
+void Game::moveCastlingRook(const Move& move) {
+	typedef Side<Us> S;
+	if (move.source != S::kingStart || abs(move.target - move.source) != 2) return;
+
+	bool kingSide = move.target > move.source;
+	uint8_t rookSource = kingSide ? S::shortRook : S::longRook;
+	uint8_t rookTarget = kingSide ? S::kingStart + 1 : S::kingStart - 1;
+	board.movePiece(rookSource, rookTarget);
+	updatePiece(Us, rook, rookSource, false);
+	updatePiece(Us, rook, rookTarget, true);
+}
 
+// Swaps the pawn that just reached the last rank on 'square' for 'type'
+void Game::replacePromotedPawn(uint8_t square, PieceType type) {
+	Color color = colorOf(board.pieceOn(square));
+	pawnKey ^= pieceKey(color, pawn, square);
+	updatePiece(color, pawn, square, false);
+	updatePiece(color, type, square, true);
+	board.removePiece(square);
+	board.placePiece(makePiece(color, type), square);
+}
@@ -1,7 +1,10 @@
 #pragma once
 #include "board.h"
-#include "Texture.h"
+#include "zobrist.h"
+#include "nnue.h"
+#include "PackedPosition.h"
 #include <vector>
+#include <memory>
 
 
 // Masks for game status
@@ -11,136 +14,127 @@ constexpr uint16_t BLACK_SHORT_CASTLE	= 0x004;
 constexpr uint16_t BLACK_LONG_CASTLE	= 0x008;
 constexpr uint16_t WHITE_CHECK			= 0x010;
 constexpr uint16_t BLACK_CHECK			= 0x020;
-constexpr uint16_t PROMOTING			= 0x040;
 constexpr uint16_t WHOSE_TURN			= 0x080;
-constexpr uint16_t PLAY_STATUS			= 0x300;
 
-// PLAY_STATUS values
+// Values of getPlayStatus()
 constexpr uint16_t PLAYING		= 0x000;
 constexpr uint16_t WHITE_WIN	= 0x100;
 constexpr uint16_t BLACK_WIN	= 0x200;
 constexpr uint16_t DRAW			= 0x300;
+// Play status not worked out since the last move
+constexpr uint16_t UNKNOWN_STATUS = 0xFFFF;
+
+// Which moves a generator produces. Evasions are only asked for in check, where the legality test leaves nothing
+// but evasions anyway
+enum GenType { CAPTURES, QUIETS, EVASIONS, LEGAL };
+
+// Constants for one side. Code templated on the color gets these folded at compile time instead of branching
+template<Color Us>
+struct Side {
+	static constexpr Color them = (Us == white) ? black : white;
+	static constexpr int forward = 8 * Us;
+	static constexpr int homeRank = (Us == white) ? 0 : 7;
+	static constexpr int pawnRank = (Us == white) ? 1 : 6;
+	static constexpr int promotionRank = (Us == white) ? 7 : 0;
+	static constexpr uint8_t kingStart = homeRank * 8 + 4;
+	static constexpr uint8_t shortRook = homeRank * 8 + 7;
+	static constexpr uint8_t longRook = homeRank * 8;
+	static constexpr uint16_t shortCastle = (Us == white) ? WHITE_SHORT_CASTLE : BLACK_SHORT_CASTLE;
+	static constexpr uint16_t longCastle = (Us == white) ? WHITE_LONG_CASTLE : BLACK_LONG_CASTLE;
+	static constexpr uint16_t check = (Us == white) ? WHITE_CHECK : BLACK_CHECK;
+};
+
+class Game;
 
-class Player;
-class HumanPlayer;
-class AIPlayer;
-struct Move;
+
+struct Move {
+	PieceCode piece = NO_PIECE;
+	uint8_t source = 0;
+	uint8_t target = 0;
+	PieceType promotion = open;	// What a pawn reaching the last rank becomes. Generated moves always name one; 'open' means a queen
+
+	Move() {}
+	Move(const Game& game, uint8_t s, uint8_t t, PieceType promotion = open);
+	Move(PieceCode p, uint8_t s, uint8_t t, PieceType promotion = open) : piece(p), source(s), target(t), promotion(promotion) {}
+};
+extern bool operator==(const Move left, const Move right);
+
+struct MoveHasher {
+	size_t operator()(const Move& move) const {
+		return std::hash<int>()(move.source | (move.target << 6) | (move.promotion << 12));
+	}
+};
 
 
 class Game {
 protected:
-	friend Move;
-	std::shared_ptr<Board> board = nullptr;
-	std::vector<std::string> moveList;
-
-	int promotionSubject = -1;
+	Board board;
 
 	uint16_t gameStatus = 0xF;
+	// Cached getPlayStatus(), cleared by every move
+	mutable uint16_t playStatus = UNKNOWN_STATUS;
 	// Where are the kings
-	uint8_t whiteKing;
-	uint8_t blackKing;
-	uint64_t white_threat_map = 0ULL;
-	uint64_t black_threat_map = 0ULL;
+	uint8_t whiteKing = 0;
+	uint8_t blackKing = 0;
 	uint8_t fiftyMoveRule = 0;
+	uint16_t fullMoveNumber = 1;
 	int8_t enPassantSquare = -1;
-
-	bool isWaitingOnPromotion() const { return gameStatus & PROMOTING; }
-	bool canCastle(Castling) const;
-	Color whoseTurn() const;
-	bool makeMove(Move);
-	bool makeLegalMove(Move);
+	// Hash of the pawns alone, updated as pawns move
+	uint64_t pawnKey = 0;
+	// Hash of the whole position, and the hashes of the positions before it since the last capture or pawn move
+	uint64_t positionKey = 0;
+	std::vector<uint64_t> keyHistory;
+	// NNUE first layer, refreshed lazily and updated incrementally while a network is loaded
+	mutable Accumulator accumulator;
+
+	template<Color Us, bool KingSide> bool canCastle() const;
+	bool movePieces(const Move&);
 	void updateChecks();
-	void handlePromotion();
-	bool hasLegalMove(Color);
-	void getLegalPieceMoves(std::vector<Move>*, std::shared_ptr<Piece>, bool = false);
-	bool isInCheck(Color) const;
-	bool check4check(Move, bool = false);
-	void updateThreatMaps();
-	void checkIfGameEnded();
-
-
-	template<class T>
-	void promote() {
-		if (promotionSubject == -1) {
-			std::cerr << "No piece able to promote!";
-			return;
-		}
-
-		std::shared_ptr<Piece> toDelete = board->getPiece(promotionSubject);
-		std::shared_ptr<Piece> promotedPiece = createPiece<T>(toDelete->getColor(), toDelete->getPosition());
-		board->placePiece(promotedPiece, promotionSubject);
-		promotionSubject = -1;
-		gameStatus &= ~PROMOTING;
-
-		std::string promotionMove = moveList[moveList.size() - 1];
-		moveList.pop_back();
-		moveList[moveList.size() - 1] = promotionMove + "=" + promotedPiece->textboardSymbol();
-		gameStatus ^= WHOSE_TURN;
-	}
+	void replacePromotedPawn(uint8_t, PieceType);
+	bool hasInsufficientMaterial() const;
+	uint64_t calculatePawnKey() const;
+	uint64_t calculatePositionKey() const;
+	uint64_t stateKey() const;
+	void updatePiece(Color, PieceType, uint8_t, bool);
+	void updateAccumulator(Color, PieceType, uint8_t, bool);
+	void getLegalPieceMoves(std::vector<Move>*, uint8_t) const;
+	template<Color Us, GenType Type, typename Visit> bool visitLegalMoves(Visit&&) const;
+	template<Color Us, GenType Type> void generateMoves(std::vector<Move>*) const;
+	template<Color Us> bool isLegal(const Move&) const;
+	template<Color Us> void updateCastlingRights(const Move&);
+	template<Color Us> void moveCastlingRook(const Move&);
+
 public:
 	Game();
 	Game(Game*);
 	Game(std::shared_ptr<Game>);
+	Game(const PackedPosition&);
+	virtual ~Game() {}
 
-	int8_t getPlayStatus() const;
-	void makePlayerMove(Move&);
-	void getAllLegalMoves(std::vector<Move>*, Color);
-	float getMaterialDifference();
-};
-
-class GraphicalGame : public Game {
-	unsigned int fbo = 0;
-	Shader* colorShader = nullptr;
-	Shader* pieceShader = nullptr;
-
-	GLuint boardGraphic = 0;
-	Texture* queenPromotion = 0;
-	Texture* rookPromotion = 0;
-	Texture* knightPromotion = 0;
-	Texture* bishopPromotion = 0;
-	std::shared_ptr<Piece> held = nullptr;
-
-	Player* whitePlayer = 0;
-	Player* blackPlayer = 0;
-
-
-	bool isHolding() { return (held != nullptr); }
-	void printBoardImage();
-	void printMoveList();
-	void grab(std::shared_ptr<Piece>);
-	std::shared_ptr<Piece> drop();
-	void handlePromotion();
-	void createPromotionTextures();
-	void deletePromotionTextures();
-public:
-	GraphicalGame(unsigned int);
-	~GraphicalGame();
-	void render();
-	void addPlayer(Player*, Color);
-
-	template<class T>
-	void promote() {
-		Game::promote<T>();
-		deletePromotionTextures();
-	}
-};
-
-
-struct Move {
-	std::shared_ptr<Piece> piece;
-	uint8_t source;
-	uint8_t target;
-
-	Move() { Move(nullptr, 0, 0); }
-	Move(Game& game, uint8_t s, uint8_t t) : source(s), target(t) {
-		piece = game.board->getPiece(s);
-	}
-	Move(std::shared_ptr<Piece> p, uint8_t s, uint8_t t) : piece(p), source(s), target(t) {}
+	uint16_t getPlayStatus() const;
+	Color whoseTurn() const;
+	void playMove(const Move&);
+	virtual void makePlayerMove(const Move&);
+	void getAllLegalMoves(std::vector<Move>*, Color, GenType = LEGAL) const;
+	bool hasLegalMove(Color) const;
+	bool isInCheck(Color) const;
+	int see(const Move&) const;
+	bool seeGE(const Move&, int = 0) const;
+	const Board& getBoard() const { return board; }
+	uint64_t getPawnKey() const { return pawnKey; }
+	uint64_t getKey() const { return positionKey; }
+	int8_t getEnPassantSquare() const { return enPassantSquare; }
+	uint16_t getFullMoveNumber() const { return fullMoveNumber; }
+	// Whether a move the piece could make leaves its own king safe. Castling rights and paths aren't checked
+	bool isLegal(const Move& move) const { return (colorOf(move.piece) == white) ? isLegal<white>(move) : isLegal<black>(move); }
+	int countRepetitions() const;
+	bool isRepetition() const { return countRepetitions() > 0; }
+	const Accumulator& getAccumulator() const;
+	PackedPosition pack() const;
+	bool fromFEN(const std::string&);
+	std::string toFEN() const;
 };
-extern bool operator==(const Move left, const Move right);
 
-struct MoveHasher {
-	size_t operator()(const Move& move) const {
-		return std::hash<int>()(move.source) ^ std::hash<int>()(move.target);
-	}
-};
+inline Move::Move(const Game& game, uint8_t s, uint8_t t, PieceType promotion) : source(s), target(t), promotion(promotion) {
+	piece = game.getBoard().pieceOn(s);
+}
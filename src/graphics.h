@@ -0,0 +1,19 @@
+#pragma once
+
+// Everything the windowed GUI needs on top of util.h. The engine itself never includes this
+#include "util.h"
+#include <glm/glm.hpp>
+#include "gl/glew.h"
+#include "GLFW/glfw3.h"
+#include "stb_image.h"
+
+constexpr const char* WIN_TITLE = "Chess AI";
+constexpr uint16_t WIN_WIDTH = 1200;
+constexpr uint16_t WIN_HEIGHT = 800;
+
+void print_vec3(glm::vec3, std::ostream& os = std::cerr);
+
+typedef std::vector<glm::ivec2> vec2s;
+typedef std::vector<glm::vec3> vec3s;
+typedef std::vector<glm::vec4> vec4s;
+typedef std::vector<unsigned int> uints;
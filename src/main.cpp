@@ -8,14 +8,43 @@
 #include "gl/glew.h"
 #include "GLFW/glfw3.h"
 #define STB_IMAGE_IMPLEMENTATION
-#include "game.h"
+#include "GraphicalGame.h"
 #include "shader.h"
 #include "Player.h"
+#include "bench.h"
+#include "PositionDB.h"
+#include <cstring>
 
 using namespace std;
 
+// While a piece is dragged the board is redrawn at most this often
+constexpr double DRAG_FRAME_SECONDS = 1.0 / 60.0;
+// With nothing happening the loop sleeps until input arrives, or this long at most
+constexpr double IDLE_WAIT_SECONDS = 1.0;
+// Frames drawn after waking, since ImGui can take a frame to show what an input changed
+constexpr int SETTLE_FRAMES = 2;
+
+
+int main(int argc, char** argv) {
+    // The AI plays with the piece-square tables unless a network is given: ChessAI --nnue <file>. A position
+    // database given with --db <file> is shown beside the board
+    std::string evaluatorName = "pst";
+    const char* nnueFile = DEFAULT_NNUE_FILE;
+    const char* databaseFile = nullptr;
+    for (int i = 1; i + 1 < argc; i++) {
+        if (strcmp(argv[i], "--nnue") == 0) {
+            evaluatorName = "nnue";
+            nnueFile = argv[i + 1];
+        }
+        if (strcmp(argv[i], "--db") == 0) databaseFile = argv[i + 1];
+    }
+
+    // Headless benchmark run: ChessAI bench [--nnue <file>]
+    if (argc > 1 && strcmp(argv[1], "bench") == 0) {
+        return runBenchmark((evaluatorName == "nnue") ? nnueFile : nullptr);
+    }
 
-int main() {
+    // Seeded after the benchmark so bench runs stay deterministic
     srand(time(0));
 
 
@@ -46,7 +75,7 @@ int main() {
         return NULL;
     }
     
-    glfwSwapInterval(0);
+    glfwSwapInterval(1);
         
     // ImGUI init
     ImGui::CreateContext();
@@ -57,6 +86,8 @@ int main() {
     ImGui::PushStyleVar(ImGuiStyleVar_WindowBorderSize, 0.0f);
 
     // Initialization for our program's graphical components
+    // Blending stays on for the whole run rather than being toggled around every piece draw
+    glEnable(GL_BLEND);
     glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
     unsigned int frameBufferObject;
     glGenFramebuffers(1, &frameBufferObject);
@@ -66,11 +97,31 @@ int main() {
     // Let's get this game going!
     std::shared_ptr<GraphicalGame> game = std::make_shared<GraphicalGame>(frameBufferObject);
     HumanPlayer whitePlayer = HumanPlayer(game, white);
-    AIPlayer blackPlayer = AIPlayer(game, black);
+    AIPlayer blackPlayer = AIPlayer(game, black, createEvaluator(evaluatorName, nnueFile));
     game->addPlayer(&whitePlayer, white);
     game->addPlayer(&blackPlayer, black);
+    PositionDB database;
+    if (databaseFile && database.open(databaseFile)) game->setDatabase(&database);
+    int settleFrames = SETTLE_FRAMES;
+    double lastFrame = glfwGetTime();
     while (!glfwWindowShouldClose(window)) {
-        glfwPollEvents();
+        if (game->needsFrame()) {
+            // Take input while waiting out the rest of the frame, so drags don't spin faster than the cap
+            double wait;
+            while ((wait = lastFrame + DRAG_FRAME_SECONDS - glfwGetTime()) > 0 && !glfwWindowShouldClose(window)) glfwWaitEventsTimeout(wait);
+            glfwPollEvents();
+            settleFrames = SETTLE_FRAMES;
+        }
+        else if (settleFrames > 0) {
+            glfwPollEvents();
+            settleFrames--;
+        }
+        else {
+            // Nothing to animate: sleep until there's input
+            glfwWaitEventsTimeout(IDLE_WAIT_SECONDS);
+            settleFrames = SETTLE_FRAMES - 1;
+        }
+        lastFrame = glfwGetTime();
 
         // Starts ImGUI frame
         ImGui_ImplOpenGL3_NewFrame();
@@ -81,8 +132,6 @@ int main() {
         glClearColor(0.f, 0.f, 0.f, 1.f);
         game->render();
 
-        ImGui::ShowDemoWindow();
-
         // Render imgui into screen
         ImGui::Render();
         glClear(GL_COLOR_BUFFER_BIT);
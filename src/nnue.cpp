@@ -0,0 +1,254 @@
+#include "nnue.h"
+#include "board.h"
+#include "Evaluator.h"
+#include <fstream>
+
+// Pick the widest instruction set the compiler is targeting. Define NNUE_NO_SIMD to force the scalar code
+#if !defined(NNUE_NO_SIMD) && defined(__AVX2__)
+#define NNUE_AVX2
+#include <immintrin.h>
+#elif !defined(NNUE_NO_SIMD) && (defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2))
+#define NNUE_SSE2
+#include <emmintrin.h>
+#endif
+
+constexpr uint32_t NNUE_MAGIC = 0x45554E4E;	// "NNUE"
+constexpr uint32_t NNUE_VERSION = 1;
+
+// Quantization: activations are clipped to [0, 127], hidden layers are scaled down by 2^6 and the output by 16
+constexpr int ACTIVATION_MAX = 127;
+constexpr int WEIGHT_SHIFT = 6;
+constexpr int OUTPUT_SCALE = 16;
+
+struct Network {
+	std::vector<int16_t> featureBiases;		// [NNUE_HALF_DIMENSIONS]
+	std::vector<int16_t> featureWeights;	// [NNUE_INPUTS][NNUE_HALF_DIMENSIONS]
+	std::vector<int32_t> hidden1Biases;		// [NNUE_HIDDEN1]
+	std::vector<int8_t> hidden1Weights;		// [NNUE_HIDDEN1][2 * NNUE_HALF_DIMENSIONS]
+	std::vector<int32_t> hidden2Biases;		// [NNUE_HIDDEN2]
+	std::vector<int8_t> hidden2Weights;		// [NNUE_HIDDEN2][NNUE_HIDDEN1]
+	int32_t outputBias = 0;
+	std::vector<int8_t> outputWeights;		// [NNUE_HIDDEN2]
+};
+
+// Loaded once and then only read, so every search thread can share it
+static std::unique_ptr<Network> network;
+static std::string networkFile;
+
+template<typename T>
+static bool readArray(std::ifstream& in, std::vector<T>& out, size_t count) {
+	out.resize(count);
+	in.read(reinterpret_cast<char*>(out.data()), count * sizeof(T));
+	return (bool)in;
+}
+
+/*-------------------------------------------------------------------------------------------------------------*\
+* NNUE::load(const char*)
+*
+* Parameters: filepath - Path to the network file
+* Description: Reads a quantized network. The file is a header (magic, version, then the four layer sizes as
+*              uint32) followed by each layer's biases and weights in order, all little endian
+* Return Value: True if the network loaded, false if the file is missing or doesn't match this network's shape
+\*-------------------------------------------------------------------------------------------------------------*/
+bool NNUE::load(const char* filepath) {
+	std::ifstream in(filepath, std::ios::in | std::ios::binary);
+	if (!in) return false;
+
+	uint32_t header[6];
+	in.read(reinterpret_cast<char*>(header), sizeof(header));
+	if (!in || header[0] != NNUE_MAGIC || header[1] != NNUE_VERSION) return false;
+	if (header[2] != NNUE_INPUTS || header[3] != NNUE_HALF_DIMENSIONS || header[4] != NNUE_HIDDEN1 || header[5] != NNUE_HIDDEN2) return false;
+
+	std::unique_ptr<Network> loaded = std::make_unique<Network>();
+	bool ok = readArray(in, loaded->featureBiases, NNUE_HALF_DIMENSIONS)
+		&& readArray(in, loaded->featureWeights, (size_t)NNUE_INPUTS * NNUE_HALF_DIMENSIONS)
+		&& readArray(in, loaded->hidden1Biases, NNUE_HIDDEN1)
+		&& readArray(in, loaded->hidden1Weights, NNUE_HIDDEN1 * 2 * NNUE_HALF_DIMENSIONS)
+		&& readArray(in, loaded->hidden2Biases, NNUE_HIDDEN2)
+		&& readArray(in, loaded->hidden2Weights, NNUE_HIDDEN2 * NNUE_HIDDEN1);
+	in.read(reinterpret_cast<char*>(&loaded->outputBias), sizeof(int32_t));
+	ok = ok && in && readArray(in, loaded->outputWeights, NNUE_HIDDEN2);
+	if (!ok) return false;
+
+	network = std::move(loaded);
+	networkFile = filepath;
+	return true;
+}
+
+bool NNUE::isLoaded() {
+	return network != nullptr;
+}
+
+const std::string& NNUE::loadedFile() {
+	return networkFile;
+}
+
+// Input index of a non-king piece as seen from one side. Black's view is flipped so both sides look "up" the board
+static int featureIndex(int perspective, uint8_t kingSquare, Color color, PieceType type, uint8_t square) {
+	if (perspective == 1) {
+		kingSquare ^= 56;
+		square ^= 56;
+	}
+	bool ownPiece = (color == white) == (perspective == 0);
+	int pieceIndex = (type - pawn) * 2 + (ownPiece ? 0 : 1);
+	return kingSquare * 641 + 1 + pieceIndex * 64 + square;
+}
+
+// accumulator += or -= one column of feature weights
+static void applyFeature(int16_t* accumulator, const int16_t* weights, bool added) {
+#if defined(NNUE_AVX2)
+	for (int i = 0; i < NNUE_HALF_DIMENSIONS; i += 16) {
+		__m256i a = _mm256_load_si256(reinterpret_cast<const __m256i*>(accumulator + i));
+		__m256i w = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(weights + i));
+		a = (added) ? _mm256_add_epi16(a, w) : _mm256_sub_epi16(a, w);
+		_mm256_store_si256(reinterpret_cast<__m256i*>(accumulator + i), a);
+	}
+#elif defined(NNUE_SSE2)
+	for (int i = 0; i < NNUE_HALF_DIMENSIONS; i += 8) {
+		__m128i a = _mm_load_si128(reinterpret_cast<const __m128i*>(accumulator + i));
+		__m128i w = _mm_loadu_si128(reinterpret_cast<const __m128i*>(weights + i));
+		a = (added) ? _mm_add_epi16(a, w) : _mm_sub_epi16(a, w);
+		_mm_store_si128(reinterpret_cast<__m128i*>(accumulator + i), a);
+	}
+#else
+	for (int i = 0; i < NNUE_HALF_DIMENSIONS; i++) {
+		accumulator[i] += (added) ? weights[i] : -weights[i];
+	}
+#endif
+}
+
+/*-------------------------------------------------------------------------------------------------------------*\
+* NNUE::refresh(Accumulator&, int, const Board&, uint8_t)
+*
+* Parameters: accumulator - Accumulator to rebuild
+*             perspective - 0 for white's half, 1 for black's
+*             board - Current board
+*             kingSquare - Square of the perspective's own king
+* Description: Rebuilds one half of the accumulator from every piece on the board. Needed at the root and whenever
+*              that side's king moves, since every feature depends on the king square
+\*-------------------------------------------------------------------------------------------------------------*/
+void NNUE::refresh(Accumulator& accumulator, int perspective, const Board& board, uint8_t kingSquare) {
+	int16_t* values = accumulator.values[perspective];
+	std::copy(network->featureBiases.begin(), network->featureBiases.end(), values);
+
+	Bitboard pieces = board.pieces() & ~board.pieces(king);
+	while (pieces) {
+		int square = popLsb(pieces);
+		PieceCode piece = board.pieceOn(square);
+		int index = featureIndex(perspective, kingSquare, colorOf(piece), typeOf(piece), square);
+		applyFeature(values, &network->featureWeights[(size_t)index * NNUE_HALF_DIMENSIONS], true);
+	}
+	accumulator.computed[perspective] = true;
+}
+
+// Adds or removes one piece from one half of the accumulator
+void NNUE::updateFeature(Accumulator& accumulator, int perspective, uint8_t kingSquare, Color color, PieceType type, uint8_t square, bool added) {
+	int index = featureIndex(perspective, kingSquare, color, type, square);
+	applyFeature(accumulator.values[perspective], &network->featureWeights[(size_t)index * NNUE_HALF_DIMENSIONS], added);
+}
+
+// Clamps 'count' int16 values to [0, 127] and narrows them to bytes
+static void clippedReLU(const int16_t* input, uint8_t* output, int count) {
+#if defined(NNUE_AVX2)
+	const __m256i zero = _mm256_setzero_si256();
+	const __m256i max = _mm256_set1_epi16(ACTIVATION_MAX);
+	for (int i = 0; i < count; i += 32) {
+		__m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(input + i));
+		__m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(input + i + 16));
+		a = _mm256_max_epi16(_mm256_min_epi16(a, max), zero);
+		b = _mm256_max_epi16(_mm256_min_epi16(b, max), zero);
+		// packus works within 128 bit lanes, so put the 64 bit blocks back in order afterwards
+		__m256i packed = _mm256_permute4x64_epi64(_mm256_packus_epi16(a, b), 0xD8);
+		_mm256_storeu_si256(reinterpret_cast<__m256i*>(output + i), packed);
+	}
+#elif defined(NNUE_SSE2)
+	const __m128i zero = _mm_setzero_si128();
+	const __m128i max = _mm_set1_epi16(ACTIVATION_MAX);
+	for (int i = 0; i < count; i += 16) {
+		__m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(input + i));
+		__m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(input + i + 8));
+		a = _mm_max_epi16(_mm_min_epi16(a, max), zero);
+		b = _mm_max_epi16(_mm_min_epi16(b, max), zero);
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(output + i), _mm_packus_epi16(a, b));
+	}
+#else
+	for (int i = 0; i < count; i++) {
+		output[i] = (uint8_t)std::min(std::max((int)input[i], 0), ACTIVATION_MAX);
+	}
+#endif
+}
+
+// Dot product of 'count' unsigned activations with signed weights. 'count' is a multiple of 32
+static int32_t dot(const uint8_t* input, const int8_t* weights, int count) {
+#if defined(NNUE_AVX2)
+	const __m256i ones = _mm256_set1_epi16(1);
+	__m256i sum = _mm256_setzero_si256();
+	for (int i = 0; i < count; i += 32) {
+		__m256i x = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(input + i));
+		__m256i w = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(weights + i));
+		// u8 * i8 pairs summed to i16, then pairs of those summed to i32
+		sum = _mm256_add_epi32(sum, _mm256_madd_epi16(_mm256_maddubs_epi16(x, w), ones));
+	}
+	__m128i half = _mm_add_epi32(_mm256_castsi256_si128(sum), _mm256_extracti128_si256(sum, 1));
+	half = _mm_add_epi32(half, _mm_shuffle_epi32(half, 0x4E));
+	half = _mm_add_epi32(half, _mm_shuffle_epi32(half, 0xB1));
+	return _mm_cvtsi128_si32(half);
+#elif defined(NNUE_SSE2)
+	// No byte multiply before SSSE3, so widen both operands to i16 and use madd
+	const __m128i zero = _mm_setzero_si128();
+	__m128i sum = _mm_setzero_si128();
+	for (int i = 0; i < count; i += 16) {
+		__m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(input + i));
+		__m128i w = _mm_loadu_si128(reinterpret_cast<const __m128i*>(weights + i));
+		__m128i xLow = _mm_unpacklo_epi8(x, zero);
+		__m128i xHigh = _mm_unpackhi_epi8(x, zero);
+		__m128i wLow = _mm_srai_epi16(_mm_unpacklo_epi8(w, w), 8);
+		__m128i wHigh = _mm_srai_epi16(_mm_unpackhi_epi8(w, w), 8);
+		sum = _mm_add_epi32(sum, _mm_madd_epi16(xLow, wLow));
+		sum = _mm_add_epi32(sum, _mm_madd_epi16(xHigh, wHigh));
+	}
+	sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, 0x4E));
+	sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, 0xB1));
+	return _mm_cvtsi128_si32(sum);
+#else
+	int32_t sum = 0;
+	for (int i = 0; i < count; i++) sum += input[i] * weights[i];
+	return sum;
+#endif
+}
+
+// Fully connected layer followed by the scaled clipped ReLU
+static void hiddenLayer(const uint8_t* input, int inputs, const int8_t* weights, const int32_t* biases, uint8_t* output, int outputs) {
+	for (int i = 0; i < outputs; i++) {
+		int32_t sum = biases[i] + dot(input, weights + i * inputs, inputs);
+		output[i] = (uint8_t)std::min(std::max(sum >> WEIGHT_SHIFT, 0), ACTIVATION_MAX);
+	}
+}
+
+/*-------------------------------------------------------------------------------------------------------------*\
+* NNUE::evaluate(const Accumulator&, Color)
+*
+* Parameters: accumulator - Up to date accumulator for the position
+*             sideToMove - Player to move, whose half goes first into the dense layers
+* Description: Runs the dense layers on top of the accumulator
+* Return Value: Score in centipawns from the point of view of 'sideToMove'
+\*-------------------------------------------------------------------------------------------------------------*/
+int NNUE::evaluate(const Accumulator& accumulator, Color sideToMove) {
+	alignas(32) uint8_t transformed[2 * NNUE_HALF_DIMENSIONS];
+	alignas(32) uint8_t hidden1[NNUE_HIDDEN1];
+	alignas(32) uint8_t hidden2[NNUE_HIDDEN2];
+
+	int us = (sideToMove == white) ? 0 : 1;
+	clippedReLU(accumulator.values[us], transformed, NNUE_HALF_DIMENSIONS);
+	clippedReLU(accumulator.values[1 - us], transformed + NNUE_HALF_DIMENSIONS, NNUE_HALF_DIMENSIONS);
+
+	hiddenLayer(transformed, 2 * NNUE_HALF_DIMENSIONS, network->hidden1Weights.data(), network->hidden1Biases.data(), hidden1, NNUE_HIDDEN1);
+	hiddenLayer(hidden1, NNUE_HIDDEN1, network->hidden2Weights.data(), network->hidden2Biases.data(), hidden2, NNUE_HIDDEN2);
+
+	int32_t output = network->outputBias + dot(hidden2, network->outputWeights.data(), NNUE_HIDDEN2);
+	return output / OUTPUT_SCALE;
+}
+
+int NNUEEvaluator::evaluate(const Game& game) {
+	return game.whoseTurn() * NNUE::evaluate(game.getAccumulator(), game.whoseTurn());
+}
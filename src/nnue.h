@@ -0,0 +1,29 @@
+#pragma once
+#include "util.h"
+
+class Board;
+
+// HalfKP network shape: (own king square, piece, square) features -> 2 x 256 -> 32 -> 32 -> 1
+constexpr int NNUE_INPUTS = 64 * 641;
+constexpr int NNUE_HALF_DIMENSIONS = 256;
+constexpr int NNUE_HIDDEN1 = 32;
+constexpr int NNUE_HIDDEN2 = 32;
+
+constexpr const char* DEFAULT_NNUE_FILE = "res/eval/nn.bin";
+
+// First layer outputs for both perspectives (white, black). Kept in the Game and updated as pieces move
+struct Accumulator {
+	alignas(32) int16_t values[2][NNUE_HALF_DIMENSIONS];
+	bool computed[2] = { false, false };
+};
+
+namespace NNUE {
+	bool load(const char* filepath);
+	bool isLoaded();
+	// Path the current network was read from, empty when none is loaded
+	const std::string& loadedFile();
+
+	void refresh(Accumulator&, int perspective, const Board&, uint8_t kingSquare);
+	void updateFeature(Accumulator&, int perspective, uint8_t kingSquare, Color, PieceType, uint8_t square, bool added);
+	int evaluate(const Accumulator&, Color sideToMove);
+}
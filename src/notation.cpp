@@ -0,0 +1,152 @@
+#include "notation.h"
+#include "attacks.h"
+
+static PieceType pieceFromLetter(char letter) {
+	switch (letter) {
+	case 'N': return knight;
+	case 'B': return bishop;
+	case 'R': return rook;
+	case 'Q': return queen;
+	case 'K': return king;
+	default: return open;
+	}
+}
+
+// Castling is rare enough to match against the generated moves, which check the rights and the king's path
+static bool parseCastle(const Game& game, bool kingSide, Move& move) {
+	std::vector<Move> legalMoves;
+	game.getAllLegalMoves(&legalMoves, game.whoseTurn(), QUIETS);
+	for (const Move& legal : legalMoves) {
+		if (typeOf(legal.piece) == king && legal.target == legal.source + (kingSide ? 2 : -2)) {
+			move = legal;
+			return true;
+		}
+	}
+	return false;
+}
+
+bool parseSAN(const Game& game, std::string_view san, Move& move) {
+	// Drop check marks and annotations
+	while (!san.empty() && (san.back() == '+' || san.back() == '#' || san.back() == '!' || san.back() == '?')) san.remove_suffix(1);
+	if (san == "O-O" || san == "0-0") return parseCastle(game, true, move);
+	if (san == "O-O-O" || san == "0-0-0") return parseCastle(game, false, move);
+
+	// Promotion piece, written "e8=Q" or "e8Q"
+	PieceType promotion = open;
+	if (san.size() > 2 && pieceFromLetter(san.back()) != open && san.back() != 'K') {
+		promotion = pieceFromLetter(san.back());
+		san.remove_suffix((san[san.size() - 2] == '=') ? 2 : 1);
+	}
+	if (san.size() < 2) return false;
+
+	char targetFile = san[san.size() - 2];
+	char targetRank = san[san.size() - 1];
+	if (targetFile < 'a' || targetFile > 'h' || targetRank < '1' || targetRank > '8') return false;
+	int target = (targetRank - '1') * 8 + (targetFile - 'a');
+	san.remove_suffix(2);
+
+	PieceType type = pawn;
+	if (!san.empty() && pieceFromLetter(san.front()) != open) {
+		type = pieceFromLetter(san.front());
+		san.remove_prefix(1);
+	}
+
+	// Whatever is left narrows down the moving piece
+	Bitboard fromMask = ~0ULL;
+	bool capture = false;
+	for (char c : san) {
+		if (c >= 'a' && c <= 'h') fromMask &= fileBB(c - 'a');
+		else if (c >= '1' && c <= '8') fromMask &= rankBB(c - '1');
+		else if (c == 'x' || c == ':') capture = true;
+		else if (c != '-') return false;
+	}
+
+	const Board& board = game.getBoard();
+	Color us = game.whoseTurn();
+	Color them = (Color)-us;
+	Bitboard ours = board.pieces(us, type);
+	Bitboard occupied = board.pieces();
+	if (board.pieces(us) & squareBB(target)) return false;
+	// Only a pawn reaching the last rank promotes, and then it has to say to what
+	bool lastRank = target / 8 == ((us == white) ? 7 : 0);
+	if ((type == pawn && lastRank) != (promotion != open)) return false;
+
+	Bitboard candidates = 0;
+	switch (type) {
+	case pawn:
+		if (capture || fromMask != ~0ULL) {
+			bool enemyOnTarget = (board.pieces(them) & squareBB(target)) != 0;
+			if (!enemyOnTarget && target != game.getEnPassantSquare()) return false;
+			candidates = pawnAttacks(them, target) & ours;
+		}
+		else if (!(occupied & squareBB(target))) {
+			int single = target - 8 * us;
+			int twice = target - 16 * us;
+			if (single >= 0 && single < 64 && (ours & squareBB(single))) candidates = squareBB(single);
+			else if (twice / 8 == ((us == white) ? 1 : 6) && !(occupied & squareBB(single)) && (ours & squareBB(twice))) candidates = squareBB(twice);
+		}
+		break;
+	case knight:	candidates = knightAttacks(target) & ours; break;
+	case bishop:	candidates = bishopAttacks(target, occupied) & ours; break;
+	case rook:		candidates = rookAttacks(target, occupied) & ours; break;
+	case queen:		candidates = (bishopAttacks(target, occupied) | rookAttacks(target, occupied)) & ours; break;
+	case king:		candidates = kingAttacks(target) & ours; break;
+	default: break;
+	}
+	candidates &= fromMask;
+
+	// Disambiguation can be left off when the other piece is pinned, so only a single legal candidate counts
+	int found = 0;
+	while (candidates) {
+		int source = popLsb(candidates);
+		Move candidate(board.pieceOn(source), (uint8_t)source, (uint8_t)target, promotion);
+		if (!game.isLegal(candidate)) continue;
+		move = candidate;
+		found++;
+	}
+	return found == 1;
+}
+
+std::string toSAN(const Game& game, const Move& move) {
+	const Board& board = game.getBoard();
+	PieceType type = typeOf(move.piece);
+	std::string san;
+
+	if (type == king && abs(move.target - move.source) == 2) san = (move.target > move.source) ? "O-O" : "O-O-O";
+	else {
+		bool capture = board.pieceOn(move.target) || (type == pawn && move.target == game.getEnPassantSquare());
+		if (type == pawn) {
+			if (capture) san += (char)('a' + move.source % 8);
+		}
+		else {
+			san += pieceSymbol(makePiece(white, type));
+
+			// Another piece of the same kind that can reach the square means naming the file, else the rank, else both
+			std::vector<Move> legalMoves;
+			game.getAllLegalMoves(&legalMoves, colorOf(move.piece));
+			bool ambiguous = false, sameFile = false, sameRank = false;
+			for (const Move& legal : legalMoves) {
+				if (legal.piece != move.piece || legal.target != move.target || legal.source == move.source) continue;
+				ambiguous = true;
+				sameFile |= legal.source % 8 == move.source % 8;
+				sameRank |= legal.source / 8 == move.source / 8;
+			}
+			if (ambiguous && (!sameFile || sameRank)) san += (char)('a' + move.source % 8);
+			if (ambiguous && sameFile) san += (char)('1' + move.source / 8);
+		}
+
+		if (capture) san += 'x';
+		san += (char)('a' + move.target % 8);
+		san += (char)('1' + move.target / 8);
+		if (type == pawn && (move.target / 8 == 0 || move.target / 8 == 7)) {
+			san += '=';
+			san += pieceSymbol(makePiece(white, (move.promotion != open) ? move.promotion : queen));
+		}
+	}
+
+	Game after(game);
+	after.playMove(move);
+	Color them = after.whoseTurn();
+	if (after.isInCheck(them)) san += after.hasLegalMove(them) ? '+' : '#';
+	return san;
+}
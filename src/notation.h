@@ -0,0 +1,27 @@
+#pragma once
+#include "game.h"
+#include <string_view>
+
+/*-------------------------------------------------------------------------------------------------------------*\
+* parseSAN(const Game&, std::string_view, Move&)
+*
+* Parameters: game - Position the move is played in
+*             san - Move in Standard Algebraic Notation, such as "Nbd7", "exd6", "e8=Q+" or "O-O". Check marks
+*                   and annotations like "!?" are allowed
+*             move - Set to the move on success
+* Description: Resolves the move from the attack tables instead of generating every legal move, only testing
+*              legality when more than one piece could reach the square
+* Return Value: True if 'san' names exactly one legal move
+\*-------------------------------------------------------------------------------------------------------------*/
+bool parseSAN(const Game& game, std::string_view san, Move& move);
+
+/*-------------------------------------------------------------------------------------------------------------*\
+* toSAN(const Game&, const Move&)
+*
+* Parameters: game - Position before the move
+*             move - Legal move in 'game'
+* Description: Writes the move in Standard Algebraic Notation, with the source file or rank added only when another
+*              piece of the same kind could also reach the square, and "+" or "#" for check and checkmate
+* Return Value: The move as SAN, such as "Nbd7", "exd6", "e8=Q+" or "O-O"
+\*-------------------------------------------------------------------------------------------------------------*/
+std::string toSAN(const Game& game, const Move& move);
@@ -0,0 +1,224 @@
+#include "pgn.h"
+#include "notation.h"
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+
+static bool isSpace(char c) {
+	return c == ' ' || c == '\n' || c == '\r' || c == '\t';
+}
+
+static const char* skipSpace(const char* c, const char* end) {
+	while (c < end && isSpace(*c)) c++;
+	return c;
+}
+
+static bool isResult(std::string_view token) {
+	return token == "1-0" || token == "0-1" || token == "1/2-1/2" || token == "*";
+}
+
+std::string_view PGNGame::tag(std::string_view name) const {
+	for (const PGNTag& tag : tags) {
+		if (tag.name == name) return tag.value;
+	}
+	return std::string_view();
+}
+
+PGNReader::PGNReader(size_t chunkSize) : buffer(chunkSize ? chunkSize : PGN_CHUNK_SIZE) {}
+
+/*-------------------------------------------------------------------------------------------------------------*\
+* PGNReader::parseGame(const char*, const char*, bool)
+*
+* Parameters: c - Start of the game's text
+*             end - End of the text in the buffer
+*             atEnd - No more text follows 'end'. Otherwise a game running into 'end' may just be cut off
+* Description: Reads one game's tags and movetext into 'current', playing the moves on 'game' as it goes. Once a
+*              move can't be played the rest of the movetext is skipped and the error noted
+* Return Value: Where the next game starts, or nullptr if the game is cut off by the end of the buffer
+\*-------------------------------------------------------------------------------------------------------------*/
+const char* PGNReader::parseGame(const char* c, const char* end, bool atEnd) {
+	current.tags.clear();
+	current.moves.clear();
+	current.result = std::string_view();
+	current.error = nullptr;
+	game = Game();
+
+	// Tag pairs: [Name "Value"]. Lines starting with '%' are escapes and are ignored
+	while ((c = skipSpace(c, end)) < end && (*c == '[' || *c == '%')) {
+		const char* lineEnd = (const char*)memchr(c, '\n', end - c);
+		if (!lineEnd && !atEnd) return nullptr;
+		if (!lineEnd) lineEnd = end;
+		if (*c == '%') {
+			c = lineEnd;
+			continue;
+		}
+
+		const char* name = skipSpace(c + 1, lineEnd);
+		const char* nameEnd = name;
+		while (nameEnd < lineEnd && !isSpace(*nameEnd) && *nameEnd != '"') nameEnd++;
+		const char* value = (const char*)memchr(nameEnd, '"', lineEnd - nameEnd);
+		c = lineEnd;
+		if (!value) continue;
+
+		const char* valueEnd = ++value;
+		while (valueEnd < lineEnd && *valueEnd != '"') valueEnd += (*valueEnd == '\\' && valueEnd + 1 < lineEnd) ? 2 : 1;
+		current.tags.push_back({ std::string_view(name, nameEnd - name), std::string_view(value, valueEnd - value) });
+	}
+
+	std::string_view fen = current.tag("FEN");
+	if (!fen.empty() && !game.fromFEN(std::string(fen))) current.error = "Invalid FEN";
+
+	// Movetext, up to the game termination marker
+	while (true) {
+		c = skipSpace(c, end);
+		if (c == end) {
+			if (!atEnd) return nullptr;
+			break;
+		}
+
+		// A new tag section means this game ended without a marker
+		if (*c == '[') break;
+
+		if (*c == '{' || *c == ';' || *c == '%') {
+			const char* close = (const char*)memchr(c, (*c == '{') ? '}' : '\n', end - c);
+			if (!close && !atEnd) return nullptr;
+			c = (close) ? close + 1 : end;
+			continue;
+		}
+
+		// Variations, which can nest and hold comments of their own
+		if (*c == '(' || *c == ')') {
+			int depth = 0;
+			do {
+				if (*c == '(') depth++;
+				else if (*c == ')') depth--;
+				else if (*c == '{') {
+					const char* close = (const char*)memchr(c, '}', end - c);
+					if (!close) break;
+					c = close;
+				}
+				c++;
+			} while (depth > 0 && c < end);
+			if (depth > 0 && !atEnd) return nullptr;
+			continue;
+		}
+
+		const char* start = c;
+		while (c < end && !isSpace(*c) && *c != '{' && *c != '(' && *c != ')' && *c != ';') c++;
+		if (c == end && !atEnd) return nullptr;
+		std::string_view token(start, c - start);
+
+		if (isResult(token)) {
+			current.result = token;
+			break;
+		}
+		if (token[0] == '$') continue;
+
+		// Move numbers, which may run straight into the move: "12.", "12...", "12.e4"
+		size_t digits = 0;
+		while (digits < token.size() && token[digits] >= '0' && token[digits] <= '9') digits++;
+		if (digits == token.size()) continue;
+		if (token[digits] == '.') {
+			while (digits < token.size() && token[digits] == '.') digits++;
+			token.remove_prefix(digits);
+			if (token.empty()) continue;
+		}
+
+		if (current.error) continue;
+		Move move;
+		if (!parseSAN(game, token, move)) {
+			current.error = "Illegal or ambiguous move";
+			continue;
+		}
+		game.playMove(move);
+		current.moves.push_back(move);
+	}
+	return c;
+}
+
+// Hands every complete game in the buffer to the callback. Returns how many bytes were used up
+size_t PGNReader::parseGames(const char* data, size_t size, bool atEnd, const PGNCallback& callback, bool& stopped) {
+	const char* end = data + size;
+	const char* c = data;
+	while ((c = skipSpace(c, end)) < end) {
+		const char* next = parseGame(c, end, atEnd);
+		if (!next) break;
+		c = next;
+		if (current.tags.empty() && current.moves.empty() && current.result.empty()) continue;
+
+		stats.games++;
+		stats.moves += current.moves.size();
+		if (current.error) stats.errors++;
+		current.position = &game;
+		if (!callback(current)) {
+			stopped = true;
+			break;
+		}
+	}
+	return c - data;
+}
+
+/*-------------------------------------------------------------------------------------------------------------*\
+* PGNReader::readFile(const char*, const PGNCallback&)
+*
+* Parameters: filepath - PGN file to read
+*             callback - Called with each game in the file, in order
+* Description: Reads the file a chunk at a time. Whatever is left of a game cut off at the end of a chunk is moved
+*              to the front of the buffer and finished once the next chunk is in
+* Return Value: False if the file couldn't be opened
+\*-------------------------------------------------------------------------------------------------------------*/
+bool PGNReader::readFile(const char* filepath, const PGNCallback& callback) {
+	std::FILE* file = std::fopen(filepath, "rb");
+	if (!file) {
+		std::cerr << "Failed to open PGN file " << filepath << std::endl;
+		return false;
+	}
+
+	auto start = std::chrono::steady_clock::now();
+	size_t filled = 0;
+	bool atEnd = false;
+	bool stopped = false;
+	while (!atEnd && !stopped) {
+		// A single game larger than the buffer
+		if (filled == buffer.size()) buffer.resize(buffer.size() * 2);
+
+		size_t got = std::fread(buffer.data() + filled, 1, buffer.size() - filled, file);
+		stats.bytes += got;
+		filled += got;
+		atEnd = (got == 0) || std::feof(file);
+
+		size_t used = parseGames(buffer.data(), filled, atEnd, callback, stopped);
+		memmove(buffer.data(), buffer.data() + used, filled - used);
+		filled -= used;
+	}
+	std::fclose(file);
+
+	std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+	stats.seconds += elapsed.count();
+	return true;
+}
+
+void PGNReader::read(const char* data, size_t size, const PGNCallback& callback) {
+	auto start = std::chrono::steady_clock::now();
+	bool stopped = false;
+	stats.bytes += size;
+	parseGames(data, size, true, callback, stopped);
+
+	std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+	stats.seconds += elapsed.count();
+}
+
+int runPGNIngest(const char* filepath, std::ostream& os) {
+	PGNReader reader;
+	if (!reader.readFile(filepath, [](const PGNGame&) { return true; })) return 1;
+
+	const PGNStats& stats = reader.getStats();
+	os << "Games:            " << stats.games << std::endl;
+	os << "Moves:            " << stats.moves << std::endl;
+	os << "Errors:           " << stats.errors << std::endl;
+	os << "Size (MB):        " << stats.bytes / (1024.0 * 1024.0) << std::endl;
+	os << "Time (s):         " << stats.seconds << std::endl;
+	os << "Games/sec:        " << stats.gamesPerSecond() << std::endl;
+	os << "MB/sec:           " << stats.megabytesPerSecond() << std::endl;
+	return 0;
+}
@@ -0,0 +1,70 @@
+#pragma once
+#include "game.h"
+#include <functional>
+#include <string_view>
+
+// Bytes read from the file at a time. A game longer than this grows the buffer
+constexpr size_t PGN_CHUNK_SIZE = 1 << 22;
+
+// One tag pair, such as [White "Carlsen, Magnus"]. Escapes in the value are left as written
+struct PGNTag {
+	std::string_view name;
+	std::string_view value;
+};
+
+// A game as handed to the callback. The views point into the reader's buffer and are only valid during the call
+struct PGNGame {
+	std::vector<PGNTag> tags;
+	std::vector<Move> moves;		// Moves up to the first one that couldn't be played
+	std::string_view result;		// "1-0", "0-1", "1/2-1/2", "*", or empty if the game had no termination marker
+	const Game* position = nullptr;	// Position after the last move in 'moves'
+	const char* error = nullptr;	// Why the movetext stopped being read, or nullptr if every move was played
+
+	std::string_view tag(std::string_view name) const;
+};
+
+// Throughput of a read, for sizing ingestion jobs
+struct PGNStats {
+	uint64_t games = 0;
+	uint64_t moves = 0;
+	uint64_t errors = 0;			// Games with a bad FEN or a move that couldn't be played
+	uint64_t bytes = 0;
+	double seconds = 0.0;
+
+	double gamesPerSecond() const { return (seconds > 0) ? games / seconds : 0.0; }
+	double megabytesPerSecond() const { return (seconds > 0) ? bytes / (1024.0 * 1024.0) / seconds : 0.0; }
+};
+
+// Called once per game. Returning false stops the read
+typedef std::function<bool(const PGNGame&)> PGNCallback;
+
+/*-------------------------------------------------------------------------------------------------------------*\
+* PGNReader
+*
+* Description: Streams games out of PGN text. Input is read in large chunks and parsed in place: tags are views
+*              into the buffer and SAN moves are resolved straight onto a Game, so nothing is allocated per token.
+*              Comments, variations, NAGs and escape lines are skipped
+\*-------------------------------------------------------------------------------------------------------------*/
+class PGNReader {
+	std::vector<char> buffer;
+	PGNGame current;
+	Game game;
+	PGNStats stats;
+
+	const char* parseGame(const char* c, const char* end, bool atEnd);
+	size_t parseGames(const char* data, size_t size, bool atEnd, const PGNCallback&, bool& stopped);
+
+public:
+	PGNReader(size_t chunkSize = PGN_CHUNK_SIZE);
+
+	// Reads every game in the file. Returns false if the file can't be opened
+	bool readFile(const char* filepath, const PGNCallback&);
+	// Reads every game in 'size' bytes of PGN text already in memory
+	void read(const char* data, size_t size, const PGNCallback&);
+
+	// Totals over every read made with this reader
+	const PGNStats& getStats() const { return stats; }
+};
+
+// Reads a PGN file and prints games/sec and MB/sec. Returns the process exit code
+int runPGNIngest(const char* filepath, std::ostream& os = std::cout);
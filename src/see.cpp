@@ -0,0 +1,112 @@
+#include "game.h"
+#include "attacks.h"
+
+// Piece values used to trade off a sequence of captures, indexed by PieceType
+constexpr int seeValue[7] = { 0, 100, 320, 330, 500, 900, 20000 };
+
+/*-------------------------------------------------------------------------------------------------------------*\
+* Game::see(const Move&)
+*
+* Parameters: move - Capture (or quiet move) to examine
+* Description: Static Exchange Evaluation. Plays out every capture on the target square, each side always taking
+*              with its least valuable attacker and free to stop when recapturing would lose material. Sliders
+*              hidden behind a capturing piece join in as it leaves the square. No moves are made on the board
+* Return Value: Material the moving side gains, in centipawns (negative when the move loses material)
+\*-------------------------------------------------------------------------------------------------------------*/
+int Game::see(const Move& move) const {
+	uint8_t target = move.target;
+	Color side = colorOf(move.piece);
+	Bitboard occupied = board.pieces();
+
+	PieceType captured = typeOf(board.pieceOn(target));
+	if (typeOf(move.piece) == pawn && target == enPassantSquare && captured == open) {
+		captured = pawn;
+		occupied ^= squareBB(target - side * 8);
+	}
+
+	int gain[32];
+	int depth = 0;
+	gain[0] = seeValue[captured];
+	PieceType attacker = typeOf(move.piece);
+	occupied ^= squareBB(move.source);
+	Bitboard attackers = board.attackersTo(target, occupied) & occupied;
+
+	while (true) {
+		depth++;
+		side = (side == white) ? black : white;
+
+		// Score if 'side' takes the piece now on the target, assuming it gets taken back
+		gain[depth] = seeValue[attacker] - gain[depth - 1];
+
+		Bitboard ours = attackers & board.pieces(side);
+		if (!ours) break;
+
+		// Capture with the least valuable piece, then look again for attackers it was hiding
+		for (int type = pawn; type <= king; type++) {
+			if (ours & board.pieces((PieceType)type)) {
+				occupied ^= squareBB(lsb(ours & board.pieces((PieceType)type)));
+				attacker = (PieceType)type;
+				break;
+			}
+		}
+		attackers = board.attackersTo(target, occupied) & occupied;
+	}
+
+	// Each side stops capturing as soon as carrying on would leave it worse off
+	while (--depth) gain[depth - 1] = -std::max(-gain[depth - 1], gain[depth]);
+	return gain[0];
+}
+
+/*-------------------------------------------------------------------------------------------------------------*\
+* Game::seeGE(const Move&, int)
+*
+* Parameters: move - Move to examine
+*             threshold - Material the move has to win, in centipawns
+* Description: Answers see(move) >= threshold, but only plays the exchange out until the answer is known
+* Return Value: True if the move gains at least 'threshold'
+\*-------------------------------------------------------------------------------------------------------------*/
+bool Game::seeGE(const Move& move, int threshold) const {
+	uint8_t target = move.target;
+	Color side = colorOf(move.piece);
+	Bitboard occupied = board.pieces();
+
+	PieceType captured = typeOf(board.pieceOn(target));
+	if (typeOf(move.piece) == pawn && target == enPassantSquare && captured == open) {
+		captured = pawn;
+		occupied ^= squareBB(target - side * 8);
+	}
+
+	// Even winning the captured piece for free isn't enough
+	int swap = seeValue[captured] - threshold;
+	if (swap < 0) return false;
+
+	// Still ahead after losing the moving piece straight back
+	swap = seeValue[typeOf(move.piece)] - swap;
+	if (swap <= 0) return true;
+
+	occupied ^= squareBB(move.source) | squareBB(target);
+	Bitboard attackers = board.attackersTo(target, occupied);
+	Bitboard diagonalSliders = board.pieces(bishop) | board.pieces(queen);
+	Bitboard straightSliders = board.pieces(rook) | board.pieces(queen);
+	int result = 1;
+
+	while (true) {
+		side = (side == white) ? black : white;
+		attackers &= occupied;
+		Bitboard ours = attackers & board.pieces(side);
+		if (!ours) break;
+		result ^= 1;
+
+		int type = pawn;
+		while (!(ours & board.pieces((PieceType)type))) type++;
+
+		// A king can only take last, otherwise the capture is illegal and the exchange goes the other way
+		if (type == king) return (attackers & ~board.pieces(side)) ? !result : result;
+
+		if ((swap = seeValue[type] - swap) < result) break;
+		occupied ^= squareBB(lsb(ours & board.pieces((PieceType)type)));
+		if (type == pawn || type == bishop || type == queen) attackers |= bishopAttacks(target, occupied) & diagonalSliders;
+		if (type == rook || type == queen) attackers |= rookAttacks(target, occupied) & straightSliders;
+	}
+	return result;
+}
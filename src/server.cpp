@@ -0,0 +1,611 @@
+#include "server.h"
+#include "MiniMaxTree.h"
+#include "uci.h"
+#include <algorithm>
+#include <cstring>
+#include <sstream>
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <winsock2.h>
+#include <ws2tcpip.h>
+typedef SOCKET SocketHandle;
+typedef WSAPOLLFD PollEntry;
+static const SocketHandle NO_SOCKET = INVALID_SOCKET;
+static int pollSockets(PollEntry* entries, size_t count, int timeout) { return WSAPoll(entries, (ULONG)count, timeout); }
+static void closeSocket(SocketHandle socket) { closesocket(socket); }
+static bool setNonBlocking(SocketHandle socket) {
+	u_long nonBlocking = 1;
+	return ioctlsocket(socket, FIONBIO, &nonBlocking) == 0;
+}
+static bool wouldBlock() { return WSAGetLastError() == WSAEWOULDBLOCK; }
+#else
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <cerrno>
+#include <poll.h>
+#include <sys/ioctl.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+typedef int SocketHandle;
+typedef pollfd PollEntry;
+static const SocketHandle NO_SOCKET = -1;
+static int pollSockets(PollEntry* entries, size_t count, int timeout) { return poll(entries, (nfds_t)count, timeout); }
+static void closeSocket(SocketHandle socket) { close(socket); }
+// ioctl rather than fcntl, whose open() would clash with the 'open' piece type
+static bool setNonBlocking(SocketHandle socket) {
+	int nonBlocking = 1;
+	return ioctl(socket, FIONBIO, &nonBlocking) == 0;
+}
+static bool wouldBlock() { return errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR; }
+
+// Deletes the socket file at 'path', if there is one. Returns false if something other than a socket is there,
+// which is left alone
+static bool removeSocketFile(const std::string& path) {
+	struct stat status;
+	if (lstat(path.c_str(), &status) != 0) return errno == ENOENT;
+	if (!S_ISSOCK(status.st_mode)) return false;
+	return unlink(path.c_str()) == 0;
+}
+#endif
+#ifndef MSG_NOSIGNAL
+#define MSG_NOSIGNAL 0
+#endif
+
+// Iterations between checks of a search's limits
+constexpr uint64_t SEARCH_CHUNK = 32;
+// How often the connection thread wakes up to notice stop()
+constexpr int POLL_INTERVAL_MS = 100;
+// A search counts as late once it overruns its budget by more than this; the limits are only checked between chunks
+constexpr int64_t SEARCH_LATE_SLACK_MS = 10;
+// A client sending a line longer than this is disconnected
+constexpr size_t MAX_LINE_LENGTH = 1 << 16;
+// A client that lets this many unread reply bytes pile up is disconnected
+constexpr size_t MAX_OUTPUT_BACKLOG = 1 << 20;
+
+typedef std::chrono::steady_clock Clock;
+
+/*-------------------------------------------------------------------------------------------------------------*\
+* ServerConnection
+*
+* Description: A client's non-blocking socket. Replies come from the connection thread and the workers alike;
+*              they're queued under a lock and written as far as the socket takes them, and the connection thread
+*              writes the rest when the socket polls writable. Nobody waits on a client that stops reading. One
+*              whose backlog passes MAX_OUTPUT_BACKLOG, or whose socket fails, is marked dropped, and only the
+*              connection thread closes sockets, so a descriptor is never reused while it's being polled
+\*-------------------------------------------------------------------------------------------------------------*/
+struct ServerConnection {
+	SocketHandle socket;
+	std::mutex writeMutex;
+	std::string input;
+	std::string output;		// Replies not yet taken by the socket
+	bool open = true;
+	bool dropped = false;
+
+	ServerConnection(SocketHandle socket) : socket(socket) {}
+
+	void send(const std::string& line) {
+		std::lock_guard<std::mutex> lock(writeMutex);
+		if (!open || dropped) return;
+		output += line;
+		output += '\n';
+		if (output.size() > MAX_OUTPUT_BACKLOG) {
+			dropped = true;
+			output.clear();
+			return;
+		}
+		write();
+	}
+
+	// Writes queued output until the socket would block
+	void flush() {
+		std::lock_guard<std::mutex> lock(writeMutex);
+		if (open && !dropped) write();
+	}
+
+	bool hasOutput() {
+		std::lock_guard<std::mutex> lock(writeMutex);
+		return !output.empty();
+	}
+
+	bool isClosing() {
+		std::lock_guard<std::mutex> lock(writeMutex);
+		return !open || dropped;
+	}
+
+	void close() {
+		std::lock_guard<std::mutex> lock(writeMutex);
+		if (open) closeSocket(socket);
+		open = false;
+	}
+
+private:
+	// Called with writeMutex held
+	void write() {
+		size_t sent = 0;
+		while (sent < output.size()) {
+			int wrote = ::send(socket, output.data() + sent, (int)(output.size() - sent), MSG_NOSIGNAL);
+			if (wrote > 0) sent += wrote;
+			else {
+				if (wrote < 0 && wouldBlock()) break;
+				dropped = true;
+				break;
+			}
+		}
+		output.erase(0, sent);
+	}
+};
+
+static double millisecondsSince(Clock::time_point start, Clock::time_point end) {
+	return std::chrono::duration<double, std::milli>(end - start).count();
+}
+
+static const char* resultOf(const Game& game) {
+	switch (game.getPlayStatus()) {
+	case WHITE_WIN: return "1-0";
+	case BLACK_WIN: return "0-1";
+	case DRAW: return "1/2-1/2";
+	default: return "*";
+	}
+}
+
+GameServer::GameServer(const ServerConfig& config, std::ostream& os) : config(config), os(os) {
+	started = Clock::now();
+	latencies.reserve(SERVER_LATENCY_WINDOW);
+	// The network is shared by every evaluator, so load it once before the workers start
+	createEvaluator(config.evaluator, config.nnueFile);
+	int threads = (config.workers > 0) ? config.workers : std::max(1u, std::thread::hardware_concurrency());
+	for (int i = 0; i < threads; i++) workers.emplace_back(&GameServer::worker, this);
+}
+
+GameServer::~GameServer() {
+	stop();
+	for (std::thread& worker : workers) worker.join();
+}
+
+void GameServer::stop() {
+	stopping = true;
+	queueReady.notify_all();
+}
+
+std::shared_ptr<ServerSession> GameServer::findSession(uint32_t id) {
+	std::lock_guard<std::mutex> lock(sessionMutex);
+	auto found = sessions.find(id);
+	return (found == sessions.end()) ? nullptr : found->second;
+}
+
+/*-------------------------------------------------------------------------------------------------------------*\
+* GameServer::execute(const std::string&, const std::shared_ptr<ServerConnection>&)
+*
+* Parameters: line - One command from a client
+*             connection - Where a later reply, the result of a 'go', is sent. May be null to drop it
+* Description: Runs everything but 'go' on the calling thread; they only touch one session, under its lock
+* Return Value: The reply to send now, or an empty string when it comes later
+\*-------------------------------------------------------------------------------------------------------------*/
+std::string GameServer::execute(const std::string& line, const std::shared_ptr<ServerConnection>& connection) {
+	std::istringstream tokens(line);
+	std::string command;
+	if (!(tokens >> command)) return "";
+
+	if (command == "new") return newSession(tokens);
+	if (command == "stats") return formatStats();
+	if (command == "shutdown") {
+		stop();
+		return "ok shutdown";
+	}
+
+	if (command != "move" && command != "go" && command != "fen" && command != "close") return "error Unknown command: " + command;
+	uint32_t id = 0;
+	if (!(tokens >> id)) return "error Expected a session id";
+	std::string idText = std::to_string(id);
+
+	if (command == "move") {
+		std::string move;
+		tokens >> move;
+		return playMove(id, move);
+	}
+	if (command == "go") return queueSearch(id, tokens, connection);
+	if (command == "fen") {
+		std::shared_ptr<ServerSession> session = findSession(id);
+		if (!session) return "error " + idText + " No such session";
+		std::lock_guard<std::mutex> lock(session->mutex);
+		return "fen " + idText + " " + session->game.toFEN();
+	}
+	// close: a search still running on the session finishes and reports, then it goes with its last reference
+	std::lock_guard<std::mutex> lock(sessionMutex);
+	if (!sessions.erase(id)) return "error " + idText + " No such session";
+	return "closed " + idText;
+}
+
+// new [fen <fen>] [moves <move>...]
+std::string GameServer::newSession(std::istream& tokens) {
+	std::shared_ptr<ServerSession> session = std::make_shared<ServerSession>();
+	std::string token, fen;
+	tokens >> token;
+	if (token == "fen") {
+		while (tokens >> token && token != "moves") fen += token + " ";
+	}
+	if (!fen.empty() && !session->game.fromFEN(fen)) return "error Invalid FEN: " + fen;
+
+	if (token == "moves") {
+		while (tokens >> token) {
+			Move move;
+			if (!parseUCIMove(session->game, token, move)) return "error Illegal move: " + token;
+			session->game.playMove(move);
+		}
+	}
+
+	std::lock_guard<std::mutex> lock(sessionMutex);
+	if (sessions.size() >= config.maxSessions) return "error Too many sessions";
+	uint32_t id = nextSession++;
+	sessions[id] = session;
+	return "session " + std::to_string(id);
+}
+
+std::string GameServer::playMove(uint32_t id, const std::string& text) {
+	std::string idText = std::to_string(id);
+	std::shared_ptr<ServerSession> session = findSession(id);
+	if (!session) return "error " + idText + " No such session";
+
+	std::lock_guard<std::mutex> lock(session->mutex);
+	if (session->searching) return "error " + idText + " Engine is searching";
+	if (session->game.getPlayStatus() != PLAYING) return "error " + idText + " Game is over";
+	Move move;
+	if (!parseUCIMove(session->game, text, move)) return "error " + idText + " Illegal move: " + text;
+	session->game.playMove(move);
+	{
+		std::lock_guard<std::mutex> metricsLock(metricsMutex);
+		totals.moves++;
+	}
+	return "ok " + idText + " " + resultOf(session->game);
+}
+
+// go <id> [movetime <ms>] [nodes <n>]. The session is marked as searching until a worker has played its move
+std::string GameServer::queueSearch(uint32_t id, std::istream& tokens, const std::shared_ptr<ServerConnection>& connection) {
+	std::string idText = std::to_string(id);
+	SearchJob job;
+	job.session = id;
+	job.connection = connection;
+	job.budget = config.moveTime;
+	std::string token;
+	while (tokens >> token) {
+		if (token == "movetime") tokens >> job.budget;
+		else if (token == "nodes") tokens >> job.nodes;
+	}
+	job.budget = std::min(std::max<int64_t>(job.budget, 1), config.maxMoveTime);
+
+	job.game = findSession(id);
+	if (!job.game) return "error " + idText + " No such session";
+	std::lock_guard<std::mutex> sessionLock(job.game->mutex);
+	if (job.game->searching) return "error " + idText + " Engine is searching";
+	if (job.game->game.getPlayStatus() != PLAYING) return "error " + idText + " Game is over";
+
+	{
+		std::lock_guard<std::mutex> lock(queueMutex);
+		if (queue.size() >= config.maxQueue) {
+			std::lock_guard<std::mutex> metricsLock(metricsMutex);
+			totals.rejected++;
+			return "error " + idText + " Server busy";
+		}
+		job.game->searching = true;
+		job.queued = Clock::now();
+		queue.push_back(std::move(job));
+	}
+	queueReady.notify_one();
+	return "";
+}
+
+void GameServer::worker() {
+	std::shared_ptr<Evaluator> evaluator = createEvaluator(config.evaluator, config.nnueFile);
+	while (true) {
+		SearchJob job;
+		{
+			std::unique_lock<std::mutex> lock(queueMutex);
+			queueReady.wait(lock, [&] { return stopping || !queue.empty(); });
+			if (stopping) return;
+			job = std::move(queue.front());
+			queue.pop_front();
+		}
+		{
+			std::lock_guard<std::mutex> lock(metricsMutex);
+			totals.running++;
+		}
+		search(job, evaluator.get());
+	}
+}
+
+/*-------------------------------------------------------------------------------------------------------------*\
+* GameServer::search(SearchJob&, Evaluator*)
+*
+* Parameters: job - The request, taken off the queue
+*             evaluator - This worker's evaluator
+* Description: Searches a copy of the session's position with whatever is left of the budget after the wait in the
+*              queue, at least one chunk even when nothing is left. Plays the move found, frees the session and
+*              sends the reply
+\*-------------------------------------------------------------------------------------------------------------*/
+void GameServer::search(SearchJob& job, Evaluator* evaluator) {
+	Clock::time_point start = Clock::now();
+	double queueMs = millisecondsSince(job.queued, start);
+	std::shared_ptr<Game> position;
+	{
+		std::lock_guard<std::mutex> lock(job.game->mutex);
+		position = std::make_shared<Game>(job.game->game);
+	}
+
+	MMTNode root(position, 0, position->whoseTurn(), evaluator);
+	MiniMaxTree tree(&root);
+	const SearchStats& stats = tree.getStats();
+	uint64_t maxNodes = std::max<uint64_t>(1, ((uint64_t)config.hashMB << 20) / (sizeof(MMTNode) + sizeof(Game) + 128));
+	while (true) {
+		uint64_t before = stats.nodes;
+		tree.search(SEARCH_CHUNK);
+		// A chunk that adds no nodes found only mates, stalemates and repetitions, so searching on changes nothing
+		if (stats.nodes == before || stats.nodes >= maxNodes || stopping) break;
+		if (job.nodes && stats.nodes >= job.nodes) break;
+		if (!job.nodes && millisecondsSince(job.queued, Clock::now()) >= job.budget) break;
+	}
+	std::vector<PVLine> lines = tree.getLines();
+	Clock::time_point end = Clock::now();
+	double searchMs = millisecondsSince(start, end);
+
+	std::string idText = std::to_string(job.session);
+	std::string reply;
+	{
+		std::lock_guard<std::mutex> lock(job.game->mutex);
+		job.game->searching = false;
+		if (lines.empty()) reply = "error " + idText + " No legal moves";
+		else {
+			job.game->game.playMove(lines[0].move);
+			reply = "bestmove " + idText + " " + moveToUCI(lines[0].move) + " " + resultOf(job.game->game)
+				+ " score " + std::to_string(lines[0].score * position->whoseTurn()) + " nodes " + std::to_string(stats.nodes)
+				+ " queue " + std::to_string((int64_t)queueMs) + " time " + std::to_string((int64_t)searchMs);
+		}
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(metricsMutex);
+		totals.searches++;
+		totals.running--;
+		if (!job.nodes && millisecondsSince(job.queued, end) > job.budget + SEARCH_LATE_SLACK_MS) totals.late++;
+		queueMsTotal += queueMs;
+		searchMsTotal += searchMs;
+		totals.maxQueueMs = std::max(totals.maxQueueMs, queueMs);
+		if (latencies.size() < SERVER_LATENCY_WINDOW) latencies.push_back(queueMs);
+		else latencies[totals.searches % SERVER_LATENCY_WINDOW] = queueMs;
+	}
+	if (job.connection) job.connection->send(reply);
+}
+
+ServerMetrics GameServer::getMetrics() {
+	ServerMetrics metrics;
+	{
+		std::lock_guard<std::mutex> lock(sessionMutex);
+		metrics.sessions = sessions.size();
+	}
+	size_t queued;
+	{
+		std::lock_guard<std::mutex> lock(queueMutex);
+		queued = queue.size();
+	}
+
+	std::lock_guard<std::mutex> lock(metricsMutex);
+	uint64_t sessionCount = metrics.sessions;
+	metrics = totals;
+	metrics.sessions = sessionCount;
+	metrics.queued = queued;
+	metrics.seconds = std::chrono::duration<double>(Clock::now() - started).count();
+	if (totals.searches) {
+		metrics.meanQueueMs = queueMsTotal / totals.searches;
+		metrics.meanSearchMs = searchMsTotal / totals.searches;
+	}
+	if (!latencies.empty()) {
+		std::vector<double> sorted = latencies;
+		std::sort(sorted.begin(), sorted.end());
+		metrics.p50QueueMs = sorted[sorted.size() / 2];
+		metrics.p99QueueMs = sorted[std::min(sorted.size() - 1, sorted.size() * 99 / 100)];
+	}
+	return metrics;
+}
+
+std::string GameServer::formatStats() {
+	ServerMetrics metrics = getMetrics();
+	std::ostringstream stats;
+	stats << "stats sessions " << metrics.sessions << " connections " << metrics.connections << " queued " << metrics.queued
+		<< " running " << metrics.running << " searches " << metrics.searches << " rejected " << metrics.rejected
+		<< " late " << metrics.late << " moves " << metrics.moves << " searchespersec " << metrics.searchesPerSecond()
+		<< " queueavg " << metrics.meanQueueMs << " queuep50 " << metrics.p50QueueMs << " queuep99 " << metrics.p99QueueMs
+		<< " queuemax " << metrics.maxQueueMs << " searchavg " << metrics.meanSearchMs;
+	return stats.str();
+}
+
+// Opens the listening socket, TCP on 127.0.0.1 or a Unix domain socket, and prints where it is
+static SocketHandle openListener(const ServerConfig& config, std::ostream& os) {
+	SocketHandle listener = NO_SOCKET;
+	if (!config.socketPath.empty()) {
+#ifdef _WIN32
+		std::cerr << "Unix domain sockets aren't supported on this platform; use -port" << std::endl;
+		return NO_SOCKET;
+#else
+		sockaddr_un address = {};
+		if (config.socketPath.size() >= sizeof(address.sun_path)) {
+			std::cerr << "Socket path too long: " << config.socketPath << std::endl;
+			return NO_SOCKET;
+		}
+		address.sun_family = AF_UNIX;
+		strcpy(address.sun_path, config.socketPath.c_str());
+		// A socket file left by a server that didn't shut down cleanly would make bind() fail
+		if (!removeSocketFile(config.socketPath)) {
+			std::cerr << config.socketPath << " exists and isn't a socket that can be replaced" << std::endl;
+			return NO_SOCKET;
+		}
+		listener = socket(AF_UNIX, SOCK_STREAM, 0);
+		if (listener == NO_SOCKET || bind(listener, (sockaddr*)&address, sizeof(address)) != 0) {
+			std::cerr << "Failed to bind " << config.socketPath << std::endl;
+			if (listener != NO_SOCKET) closeSocket(listener);
+			return NO_SOCKET;
+		}
+		os << "Listening on " << config.socketPath << std::endl;
+#endif
+	}
+	else {
+		sockaddr_in address = {};
+		address.sin_family = AF_INET;
+		address.sin_port = htons((uint16_t)config.port);
+		address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+		listener = socket(AF_INET, SOCK_STREAM, 0);
+		int reuse = 1;
+		if (listener != NO_SOCKET) setsockopt(listener, SOL_SOCKET, SO_REUSEADDR, (const char*)&reuse, sizeof(reuse));
+		if (listener == NO_SOCKET || bind(listener, (sockaddr*)&address, sizeof(address)) != 0) {
+			std::cerr << "Failed to bind 127.0.0.1:" << config.port << std::endl;
+			if (listener != NO_SOCKET) closeSocket(listener);
+			return NO_SOCKET;
+		}
+		os << "Listening on 127.0.0.1:" << config.port << std::endl;
+	}
+
+	if (listen(listener, SOMAXCONN) != 0) {
+		std::cerr << "Failed to listen for connections" << std::endl;
+		closeSocket(listener);
+		return NO_SOCKET;
+	}
+	return listener;
+}
+
+/*-------------------------------------------------------------------------------------------------------------*\
+* GameServer::run()
+*
+* Description: The connection thread. Polls the listening socket and every client, splits what arrives into
+*              lines and runs them. Searches are handed to the workers, so a slow search never holds up another
+*              client's commands, and replies are queued per connection, so neither does a client that stops
+*              reading
+* Return Value: False if the socket couldn't be opened
+\*-------------------------------------------------------------------------------------------------------------*/
+bool GameServer::run() {
+#ifdef _WIN32
+	WSADATA wsaData;
+	if (WSAStartup(MAKEWORD(2, 2), &wsaData) != 0) {
+		std::cerr << "Failed to start Winsock" << std::endl;
+		return false;
+	}
+#endif
+	SocketHandle listener = openListener(config, os);
+	if (listener == NO_SOCKET) return false;
+
+	std::vector<std::shared_ptr<ServerConnection>> connections;
+	std::vector<PollEntry> polls;
+	char buffer[1 << 14];
+	while (!stopping) {
+		polls.clear();
+		polls.push_back({ listener, POLLIN, 0 });
+		for (const std::shared_ptr<ServerConnection>& connection : connections) {
+			short events = POLLIN;
+			if (connection->hasOutput()) events |= POLLOUT;
+			polls.push_back({ connection->socket, events, 0 });
+		}
+		if (pollSockets(polls.data(), polls.size(), POLL_INTERVAL_MS) <= 0) continue;
+
+		for (size_t i = 1; i < polls.size(); i++) {
+			const std::shared_ptr<ServerConnection>& connection = connections[i - 1];
+			if (polls[i].revents & POLLOUT) connection->flush();
+			if (!(polls[i].revents & (POLLIN | POLLHUP | POLLERR))) continue;
+			int got = recv(connection->socket, buffer, sizeof(buffer), 0);
+			if (got < 0 && wouldBlock()) continue;
+			if (got <= 0) {
+				connection->close();
+				continue;
+			}
+			connection->input.append(buffer, got);
+
+			size_t lineStart = 0, lineEnd;
+			while ((lineEnd = connection->input.find('\n', lineStart)) != std::string::npos) {
+				std::string line = connection->input.substr(lineStart, lineEnd - lineStart);
+				lineStart = lineEnd + 1;
+				if (!line.empty() && line.back() == '\r') line.pop_back();
+				if (line == "quit") {
+					connection->flush();
+					connection->close();
+					break;
+				}
+				std::string reply = execute(line, connection);
+				if (!reply.empty()) connection->send(reply);
+			}
+			connection->input.erase(0, lineStart);
+			if (connection->input.size() > MAX_LINE_LENGTH) connection->close();
+		}
+		// Dropped connections are closed here, on the thread that polls them
+		connections.erase(std::remove_if(connections.begin(), connections.end(),
+			[](const std::shared_ptr<ServerConnection>& connection) {
+				if (!connection->isClosing()) return false;
+				connection->close();
+				return true;
+			}), connections.end());
+
+		if (polls[0].revents & POLLIN) {
+			SocketHandle client = accept(listener, nullptr, nullptr);
+			if (client != NO_SOCKET && setNonBlocking(client)) connections.push_back(std::make_shared<ServerConnection>(client));
+			else if (client != NO_SOCKET) closeSocket(client);
+		}
+		std::lock_guard<std::mutex> lock(metricsMutex);
+		totals.connections = connections.size();
+	}
+
+	for (const std::shared_ptr<ServerConnection>& connection : connections) connection->close();
+	closeSocket(listener);
+#ifdef _WIN32
+	WSACleanup();
+#else
+	if (!config.socketPath.empty()) removeSocketFile(config.socketPath);
+#endif
+	return true;
+}
+
+/*-------------------------------------------------------------------------------------------------------------*\
+* parseServerArgs(int, char**, ServerConfig&)
+*
+* Parameters: argc, argv - Arguments after 'server':
+*                -port <n>  -socket <path>  -workers <n>  -queue <n>  -sessions <n>  -movetime <ms>  -hash <mb>
+*                --nnue <file>
+*             config - Filled in from the arguments
+* Return Value: False on an unknown option
+\*-------------------------------------------------------------------------------------------------------------*/
+bool parseServerArgs(int argc, char** argv, ServerConfig& config) {
+	for (int i = 0; i < argc; i++) {
+		std::string option = argv[i];
+		bool hasValue = i + 1 < argc;
+		if (option == "-port" && hasValue) config.port = atoi(argv[++i]);
+		else if (option == "-socket" && hasValue) config.socketPath = argv[++i];
+		else if (option == "-workers" && hasValue) config.workers = atoi(argv[++i]);
+		else if (option == "-queue" && hasValue) config.maxQueue = std::max(1, atoi(argv[++i]));
+		else if (option == "-sessions" && hasValue) config.maxSessions = std::max(1, atoi(argv[++i]));
+		else if (option == "-movetime" && hasValue) config.moveTime = std::max(1, atoi(argv[++i]));
+		else if (option == "-hash" && hasValue) config.hashMB = std::max(1, atoi(argv[++i]));
+		else if (option == "--nnue" && hasValue) {
+			config.evaluator = "nnue";
+			config.nnueFile = argv[++i];
+		}
+		else {
+			std::cerr << "Unknown server option: " << option << std::endl;
+			return false;
+		}
+	}
+	return true;
+}
+
+int runGameServer(int argc, char** argv, std::ostream& os) {
+	ServerConfig config;
+	if (!parseServerArgs(argc, argv, config)) return 1;
+
+	GameServer server(config, os);
+	if (!server.run()) return 1;
+
+	ServerMetrics metrics = server.getMetrics();
+	os << "===========================" << std::endl;
+	os << "Searches:         " << metrics.searches << " (" << metrics.rejected << " rejected, " << metrics.late << " late)" << std::endl;
+	os << "Searches/sec:     " << metrics.searchesPerSecond() << std::endl;
+	os << "Queue latency:    " << metrics.meanQueueMs << " ms mean, " << metrics.p50QueueMs << " p50, "
+		<< metrics.p99QueueMs << " p99, " << metrics.maxQueueMs << " max" << std::endl;
+	os << "Search time:      " << metrics.meanSearchMs << " ms mean" << std::endl;
+	return 0;
+}
@@ -0,0 +1,139 @@
+#pragma once
+#include "game.h"
+#include "Evaluator.h"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <iostream>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+
+constexpr int DEFAULT_SERVER_PORT = 7878;
+// Queue latencies kept for the percentiles in the metrics
+constexpr size_t SERVER_LATENCY_WINDOW = 4096;
+
+// Settings for a server. Times are in milliseconds
+struct ServerConfig {
+	int port = DEFAULT_SERVER_PORT;	// TCP port on 127.0.0.1, used when 'socketPath' is empty
+	std::string socketPath;			// Unix domain socket to listen on instead, where the platform has them
+	int workers = 0;				// Searches run at once, or 0 for one per hardware thread
+	size_t maxQueue = 4096;			// Searches waiting beyond this are refused, so a flood can't grow latency forever
+	size_t maxSessions = 100000;
+	int64_t moveTime = 100;			// Budget of a 'go' that doesn't give one
+	int64_t maxMoveTime = 60000;
+	int hashMB = 64;				// Tree memory allowed per search
+	std::string evaluator = "pst";
+	const char* nnueFile = DEFAULT_NNUE_FILE;
+};
+
+// A game hosted by the server. 'searching' is set while a worker owns the position
+struct ServerSession {
+	std::mutex mutex;
+	Game game;
+	bool searching = false;
+};
+
+struct ServerConnection;
+
+// An engine move asked for by a client. The budget counts from when it was queued, so time spent waiting for a
+// worker comes out of the search
+struct SearchJob {
+	uint32_t session = 0;
+	std::shared_ptr<ServerSession> game;
+	std::shared_ptr<ServerConnection> connection;
+	int64_t budget = 0;
+	uint64_t nodes = 0;				// Nodes to search in place of the budget, if nonzero
+	std::chrono::steady_clock::time_point queued;
+};
+
+// Counters since the server started. Latencies are in milliseconds; the percentiles cover the most recent
+// SERVER_LATENCY_WINDOW searches
+struct ServerMetrics {
+	uint64_t sessions = 0;
+	uint64_t connections = 0;
+	uint64_t queued = 0;			// Searches waiting for a worker now
+	uint64_t running = 0;
+	uint64_t searches = 0;			// Searches finished
+	uint64_t rejected = 0;			// Searches refused because the queue was full
+	uint64_t late = 0;				// Searches that finished after their budget ran out
+	uint64_t moves = 0;				// Client moves played
+	double seconds = 0.0;
+	double meanQueueMs = 0.0;
+	double p50QueueMs = 0.0;
+	double p99QueueMs = 0.0;
+	double maxQueueMs = 0.0;
+	double meanSearchMs = 0.0;
+
+	double searchesPerSecond() const { return (seconds > 0) ? searches / seconds : 0.0; }
+};
+
+/*-------------------------------------------------------------------------------------------------------------*\
+* GameServer
+*
+* Description: Hosts any number of games for clients on a local socket. One thread reads every connection and
+*              answers cheap commands itself; engine moves go on a bounded queue served by a fixed pool of
+*              workers, each with its own evaluator. Sessions belong to the server rather than a connection, so
+*              a client can reconnect and carry on. The protocol is one command per line:
+*
+*                new [fen <fen>] [moves <move>...]	-> session <id>
+*                move <id> <move>					-> ok <id> <result>
+*                go <id> [movetime <ms>] [nodes <n>]	-> bestmove <id> <move> <result> score <cp> nodes <n> queue <ms> time <ms>
+*                fen <id>							-> fen <id> <fen>
+*                close <id>							-> closed <id>
+*                stats								-> stats <name> <value>...
+*                quit, shutdown
+*
+*              Moves are in UCI notation and results are "*", "1-0", "0-1" or "1/2-1/2". 'go' plays the move it
+*              finds. Failures answer "error [<id>] <reason>"
+\*-------------------------------------------------------------------------------------------------------------*/
+class GameServer {
+	typedef std::chrono::steady_clock Clock;
+
+	const ServerConfig config;
+	std::ostream& os;
+	std::atomic<bool> stopping{ false };
+	Clock::time_point started;
+
+	std::mutex sessionMutex;
+	std::unordered_map<uint32_t, std::shared_ptr<ServerSession>> sessions;
+	uint32_t nextSession = 1;
+
+	std::mutex queueMutex;
+	std::condition_variable queueReady;
+	std::deque<SearchJob> queue;
+	std::vector<std::thread> workers;
+
+	std::mutex metricsMutex;
+	ServerMetrics totals;
+	std::vector<double> latencies;		// Ring of the latest queue latencies
+	double queueMsTotal = 0.0;
+	double searchMsTotal = 0.0;
+
+	std::shared_ptr<ServerSession> findSession(uint32_t id);
+	std::string newSession(std::istream& tokens);
+	std::string playMove(uint32_t id, const std::string& text);
+	std::string queueSearch(uint32_t id, std::istream& tokens, const std::shared_ptr<ServerConnection>&);
+	std::string formatStats();
+	void worker();
+	void search(SearchJob&, Evaluator*);
+
+public:
+	GameServer(const ServerConfig&, std::ostream& os = std::cout);
+	~GameServer();
+
+	// Listens on the configured socket and serves clients until 'shutdown' or stop(). Returns false if the socket
+	// can't be opened
+	bool run();
+	void stop();
+	// Runs one command line for 'connection', which receives any reply sent later. Returns the immediate reply,
+	// or an empty string when there isn't one
+	std::string execute(const std::string& line, const std::shared_ptr<ServerConnection>& connection);
+	ServerMetrics getMetrics();
+};
+
+// Reads the server options, after 'server'. Returns false on an unknown option
+bool parseServerArgs(int argc, char** argv, ServerConfig&);
+// Runs the server described on the command line, after 'server'. Returns the process exit code
+int runGameServer(int argc, char** argv, std::ostream& os = std::cout);
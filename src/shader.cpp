@@ -3,6 +3,7 @@
 #include "GLFW/glfw3.h"
 #include <fstream>
 #include <string>
+#include <iostream>
 #include <cerrno>
 
 // Taken from insane coding: reads in a file as a string
@@ -52,6 +53,26 @@ Shader::Shader(const char* vertexFilepath, const char* fragmentFilepath) {
 	glAttachShader(ID, fragmentShader);
 	glLinkProgram(ID);
 
+	GLint linked;
+	glGetProgramiv(ID, GL_LINK_STATUS, &linked);
+	if (!linked) {
+		char log[512];
+		glGetProgramInfoLog(ID, sizeof(log), NULL, log);
+		std::cerr << "Failed to link shaders " << vertexFilepath << " and " << fragmentFilepath << ": " << log << std::endl;
+	}
+
+    // Cache every active uniform's location, so drawing never has to ask the driver by name
+	GLint uniformCount = 0;
+	glGetProgramiv(ID, GL_ACTIVE_UNIFORMS, &uniformCount);
+	for (GLint i = 0; i < uniformCount; i++) {
+		char name[256];
+		GLsizei length;
+		GLint size;
+		GLenum type;
+		glGetActiveUniform(ID, (GLuint)i, sizeof(name), &length, &size, &type, name);
+		uniforms[std::string(name, length)] = glGetUniformLocation(ID, name);
+	}
+
     // Cleanup
 	glDeleteShader(vertexShader);
 	glDeleteShader(fragmentShader);
@@ -70,4 +91,10 @@ void Shader::activate() {
 // Turns off any shader currently active
 void Shader::deactivate() {
 	glUseProgram(0);
+}
+
+// Looks up a uniform found when the program linked
+GLint Shader::getUniform(const std::string& name) const {
+	auto found = uniforms.find(name);
+	return (found != uniforms.end()) ? found->second : -1;
 }
\ No newline at end of file
@@ -1,12 +1,19 @@
 #pragma once
 #include "gl/glew.h"
+#include <string>
+#include <unordered_map>
 
-// Wrapper for opengl shaders
+// Wrapper for opengl shaders. Uniform locations are looked up once, when the program links
 class Shader {
+	std::unordered_map<std::string, GLint> uniforms;
 public:
 	GLuint ID;
 	Shader(const char*, const char*);
 	~Shader();
 	void activate();
 	void deactivate();
+	// The location of the uniform 'name', or -1 if the program doesn't use it
+	GLint getUniform(const std::string& name) const;
+	// Sets an integer or sampler uniform. The shader must be active
+	void setInt(const std::string& name, GLint value) const { glUniform1i(getUniform(name), value); }
 };
\ No newline at end of file
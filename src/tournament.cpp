@@ -0,0 +1,467 @@
+#include "tournament.h"
+#include "GameRecord.h"
+#include "pgn.h"
+#include "uci.h"
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <ctime>
+#include <fstream>
+#include <sstream>
+#include <thread>
+
+// Search iterations run between checks of the clock and the node limit
+constexpr uint64_t SEARCH_CHUNK = 32;
+
+typedef std::chrono::steady_clock Clock;
+
+static double scoreToElo(double score) {
+	return 400.0 * std::log10(score / (1.0 - score));
+}
+
+static double eloToScore(double elo) {
+	return 1.0 / (1.0 + std::pow(10.0, -elo / 400.0));
+}
+
+// Variance of a single game's score
+static double scoreVariance(const MatchScore& match) {
+	double s = match.score();
+	return (match.wins * (1 - s) * (1 - s) + match.draws * (0.5 - s) * (0.5 - s) + match.losses * s * s) / match.games();
+}
+
+double MatchScore::elo() const {
+	return (wins == games() || losses == games()) ? NAN : scoreToElo(score());
+}
+
+double MatchScore::eloMargin() const {
+	if (wins == games() || losses == games()) return NAN;
+	double deviation = std::sqrt(scoreVariance(*this) / games());
+	double low = std::max(score() - 1.96 * deviation, 1e-9);
+	double high = std::min(score() + 1.96 * deviation, 1 - 1e-9);
+	return (scoreToElo(high) - scoreToElo(low)) / 2;
+}
+
+double MatchScore::los() const {
+	if (wins + losses == 0) return 0.5;
+	return 0.5 * (1 + std::erf((wins - losses) / std::sqrt(2.0 * (wins + losses))));
+}
+
+/*-------------------------------------------------------------------------------------------------------------*\
+* MatchScore::llr(double, double)
+*
+* Parameters: elo0, elo1 - Elo differences under H0 and H1
+* Description: Treats each game as an independent trinomial draw and compares the likelihood of the observed scores
+*              under the two hypotheses, using the normal approximation to the score. Accept H1 once the ratio is
+*              above log((1 - beta) / alpha) and H0 once it is below log(beta / (1 - alpha))
+* Return Value: The log likelihood ratio, 0 until there is some spread in the results
+\*-------------------------------------------------------------------------------------------------------------*/
+double MatchScore::llr(double elo0, double elo1) const {
+	if (!games()) return 0.0;
+	double variance = scoreVariance(*this);
+	if (variance <= 0) return 0.0;
+	double s0 = eloToScore(elo0);
+	double s1 = eloToScore(elo1);
+	return (s1 - s0) * (2 * score() - s0 - s1) * games() / (2 * variance);
+}
+
+
+Tournament::Tournament(const TournamentConfig& config, std::ostream& os) : config(config), os(os) {
+	char text[16];
+	std::time_t now = std::time(nullptr);
+	std::strftime(text, sizeof(text), "%Y.%m.%d", std::localtime(&now));
+	date = text;
+}
+
+/*-------------------------------------------------------------------------------------------------------------*\
+* Tournament::loadOpenings()
+*
+* Description: Reads the openings file. A ".pgn" file gives one opening per game: its starting position and every
+*              move that could be played. Anything else is read as one FEN per line; EPD lines, which stop after
+*              the en passant square and go on with operations, are cut down to their first four fields
+* Return Value: False if the file couldn't be read or held no usable openings
+\*-------------------------------------------------------------------------------------------------------------*/
+bool Tournament::loadOpenings() {
+	const std::string& path = config.openingsFile;
+	if (path.empty()) {
+		openings.push_back(Opening());
+		return true;
+	}
+
+	if (path.size() > 4 && path.compare(path.size() - 4, 4, ".pgn") == 0) {
+		PGNReader reader;
+		bool read = reader.readFile(path.c_str(), [this](const PGNGame& game) {
+			if (!game.error) openings.push_back({ std::string(game.tag("FEN")), game.moves });
+			return true;
+		});
+		if (!read) return false;
+	}
+	else {
+		std::ifstream in(path);
+		if (!in) {
+			std::cerr << "Failed to open openings file " << path << std::endl;
+			return false;
+		}
+		std::string line;
+		Game game;
+		while (std::getline(in, line)) {
+			if (line.find_first_not_of(" \t\r") == std::string::npos || line[0] == '#') continue;
+			if (!line.empty() && line.back() == '\r') line.pop_back();
+			if (!game.fromFEN(line)) {
+				std::istringstream fields(line);
+				std::string field, epd;
+				for (int i = 0; i < 4 && fields >> field; i++) epd += field + " ";
+				if (!game.fromFEN(epd)) {
+					std::cerr << "Skipping bad opening: " << line << std::endl;
+					continue;
+				}
+				line = epd;
+			}
+			openings.push_back({ line, {} });
+		}
+	}
+
+	if (openings.empty()) {
+		std::cerr << "No openings in " << path << std::endl;
+		return false;
+	}
+	return true;
+}
+
+/*-------------------------------------------------------------------------------------------------------------*\
+* Tournament::run()
+*
+* Description: Starts the workers, waits for the last game and prints the match result, the Elo difference and,
+*              when asked for, where the SPRT stands
+* Return Value: False if the openings or an engine's network couldn't be read
+\*-------------------------------------------------------------------------------------------------------------*/
+bool Tournament::run() {
+	if (!loadOpenings()) return false;
+
+	// The network is shared by every evaluator, so load it once before the workers start
+	for (const TournamentEngine& engine : config.engines) {
+		createEvaluator(engine.evaluator, config.nnueFile);
+		// createEvaluator falls back to pst, which would quietly turn the match into pst against pst
+		if (engine.evaluator == "nnue" && (!NNUE::isLoaded() || NNUE::loadedFile() != config.nnueFile)) {
+			std::cerr << "Engine " << engine.name << " needs a network; stopping the match" << std::endl;
+			return false;
+		}
+	}
+	if (!config.trainingFile.empty() && !config.trainingShards && !training.open(config.trainingFile)) return false;
+
+	int threads = (config.concurrency > 0) ? config.concurrency : (int)std::max(1u, std::thread::hardware_concurrency());
+	threads = std::min(threads, config.games);
+	os << "Playing " << config.games << " games of " << config.engines[0].name << " vs " << config.engines[1].name
+		<< " on " << threads << " threads with " << openings.size() << " openings" << std::endl;
+
+	Clock::time_point start = Clock::now();
+	std::vector<std::thread> workers;
+	for (int i = 0; i < threads; i++) workers.emplace_back(&Tournament::worker, this, i);
+	for (std::thread& worker : workers) worker.join();
+	double hours = std::chrono::duration<double>(Clock::now() - start).count() / 3600.0;
+	training.close();
+
+	os << "===========================" << std::endl;
+	os << "Games:            " << score.games() << " (+" << score.wins << " =" << score.draws << " -" << score.losses << ")" << std::endl;
+	os << "Score:            " << score.score() << std::endl;
+	os << "Elo difference:   " << score.elo() << " +/- " << score.eloMargin() << std::endl;
+	os << "LOS:              " << score.los() * 100 << "%" << std::endl;
+	if (config.sprt) {
+		double llr = score.llr(config.elo0, config.elo1);
+		double lower = std::log(config.beta / (1 - config.alpha));
+		double upper = std::log((1 - config.beta) / config.alpha);
+		const char* verdict = (llr >= upper) ? "H1 accepted" : (llr <= lower) ? "H0 accepted" : "inconclusive";
+		os << "SPRT:             llr " << llr << " (" << lower << ", " << upper << ") [" << config.elo0 << ", " << config.elo1 << "] " << verdict << std::endl;
+	}
+	os << "Games/hour:       " << (uint64_t)((hours > 0) ? score.games() / hours : 0) << std::endl;
+	if (!config.trainingFile.empty()) {
+		os << "Training samples: " << sampleCount << " (" << (uint64_t)((hours > 0) ? sampleCount / hours : 0) << "/hour)" << std::endl;
+	}
+	return true;
+}
+
+void Tournament::worker(int workerIndex) {
+	TrainingWriter shard;
+	if (!config.trainingFile.empty() && config.trainingShards) shard.open(trainingShardPath(config.trainingFile, workerIndex));
+
+	std::shared_ptr<Evaluator> owned[2];
+	Evaluator* evaluators[2];
+	for (int i = 0; i < 2; i++) {
+		owned[i] = createEvaluator(config.engines[i].evaluator, config.nnueFile);
+		evaluators[i] = owned[i].get();
+	}
+
+	while (!stopped) {
+		int index = nextGame++;
+		if (index >= config.games) break;
+		playGame(index, evaluators, shard.isOpen() ? &shard : nullptr);
+	}
+}
+
+// Searches until the move's time budget or node limit is used up. The PV is empty when there are no legal moves
+PVLine Tournament::searchMove(const Game& game, Evaluator* evaluator, int64_t budget, uint64_t nodes) const {
+	Clock::time_point start = Clock::now();
+	MMTNode root(std::make_shared<Game>(game), 0, game.whoseTurn(), evaluator);
+	MiniMaxTree tree(&root);
+	const SearchStats& stats = tree.getStats();
+	uint64_t maxNodes = std::max<uint64_t>(1, ((uint64_t)config.hashMB << 20) / (sizeof(MMTNode) + sizeof(Game) + 128));
+
+	while (true) {
+		uint64_t before = stats.nodes;
+		tree.search(SEARCH_CHUNK);
+		int64_t elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(Clock::now() - start).count();
+		// A chunk that adds no nodes found only mates, stalemates and repetitions, so searching on changes nothing
+		if (stats.nodes == before || stats.nodes >= maxNodes) break;
+		if (nodes && stats.nodes >= nodes) break;
+		if (!nodes && elapsed >= budget) break;
+	}
+
+	std::vector<PVLine> lines = tree.getLines();
+	return (lines.empty()) ? PVLine() : lines[0];
+}
+
+/*-------------------------------------------------------------------------------------------------------------*\
+* Tournament::playGame(int, Evaluator*[2], TrainingWriter*)
+*
+* Parameters: index - Game number from 0. Even games give engines[0] white, odd games the same opening reversed
+*             evaluators - This worker's evaluators, indexed like config.engines
+*             shard - This worker's training file, or nullptr to share one or when samples aren't being kept
+* Description: Plays the opening moves, then lets the engines alternate until the game ends, a clock runs out or
+*              the scores they report settle it by adjudication
+\*-------------------------------------------------------------------------------------------------------------*/
+void Tournament::playGame(int index, Evaluator* evaluators[2], TrainingWriter* shard) {
+	const Opening& opening = openings[(index / 2) % openings.size()];
+	int whiteEngine = index % 2;
+
+	Game game;
+	if (!opening.fen.empty()) game.fromFEN(opening.fen);
+	GameRecord record(game);
+	for (const Move& move : opening.moves) {
+		record.record(move);
+		game.playMove(move);
+	}
+
+	SearchLimits clock;
+	clock.time[0] = clock.time[1] = config.baseTime;
+	clock.increment[0] = clock.increment[1] = config.increment;
+	int drawPlies = 0;
+	int resignStreak[2] = { 0, 0 };
+	const char* result = "*";
+	const char* termination = "normal";
+	bool keepSamples = !config.trainingFile.empty();
+	std::vector<TrainingRecord> samples;
+
+	while (true) {
+		uint16_t status = game.getPlayStatus();
+		if (status != PLAYING) {
+			result = (status == WHITE_WIN) ? "1-0" : (status == BLACK_WIN) ? "0-1" : "1/2-1/2";
+			break;
+		}
+
+		Color us = game.whoseTurn();
+		int side = colorIndex(us);
+		int engine = (us == white) ? whiteEngine : 1 - whiteEngine;
+		uint64_t nodes = (config.engines[engine].nodes) ? config.engines[engine].nodes : config.nodes;
+		bool timed = !nodes && config.baseTime;
+
+		Clock::time_point start = Clock::now();
+		PVLine line = searchMove(game, evaluators[engine], timeBudget(clock, us), nodes);
+		if (line.pv.empty()) break;
+
+		if (timed) {
+			clock.time[side] -= std::chrono::duration_cast<std::chrono::milliseconds>(Clock::now() - start).count();
+			if (clock.time[side] <= 0) {
+				result = (us == white) ? "0-1" : "1-0";
+				termination = "time forfeit";
+				break;
+			}
+			clock.time[side] += config.increment;
+		}
+
+		// The result is filled in once the game is over
+		if (keepSamples && !game.isInCheck(us) && std::abs(line.score) < MATE_BOUND) {
+			TrainingRecord sample = {};
+			sample.position = game.pack();
+			sample.setScore((int16_t)std::max(-32767, std::min(32767, line.score)));
+			samples.push_back(sample);
+		}
+
+		record.record(line.move);
+		game.playMove(line.move);
+
+		// Scores are from white's side; adjudication looks at each engine's own view of its position
+		int ours = line.score * us;
+		drawPlies = (std::abs(line.score) <= config.drawScore && game.getFullMoveNumber() >= config.drawMoveNumber) ? drawPlies + 1 : 0;
+		resignStreak[side] = (ours <= -config.resignScore) ? resignStreak[side] + 1 : 0;
+		if (config.drawCount && drawPlies >= 2 * config.drawCount) {
+			result = "1/2-1/2";
+			termination = "adjudication";
+			break;
+		}
+		if (config.resignCount && resignStreak[side] >= config.resignCount) {
+			result = (us == white) ? "0-1" : "1-0";
+			termination = "adjudication";
+			break;
+		}
+	}
+
+	int8_t outcome = (strcmp(result, "1-0") == 0) ? TRAINING_WHITE_WIN : (strcmp(result, "0-1") == 0) ? TRAINING_BLACK_WIN : TRAINING_DRAW;
+	for (TrainingRecord& sample : samples) sample.result = outcome;
+	if (shard) shard->write(samples);
+	finishGame(index, whiteEngine, record.toMovetext(result), opening.fen, result, termination, samples);
+}
+
+// Scores a finished game, writes it to the PGN file and the shared training file and reports it. Ends the match once the SPRT has decided
+void Tournament::finishGame(int index, int whiteEngine, const std::string& movetext, const std::string& fen,
+	const char* result, const char* termination, const std::vector<TrainingRecord>& samples) {
+	std::lock_guard<std::mutex> lock(resultMutex);
+	if (training.isOpen()) training.write(samples);
+	sampleCount += samples.size();
+	bool whiteWon = strcmp(result, "1-0") == 0;
+	bool blackWon = strcmp(result, "0-1") == 0;
+	if (!whiteWon && !blackWon) score.draws++;
+	else if (whiteWon == (whiteEngine == 0)) score.wins++;
+	else score.losses++;
+	finished++;
+
+	const std::string& white = config.engines[whiteEngine].name;
+	const std::string& black = config.engines[1 - whiteEngine].name;
+	if (!config.pgnFile.empty()) {
+		std::ofstream pgn(config.pgnFile, std::ios::app);
+		pgn << "[Event \"ChessAI tournament\"]\n[Site \"?\"]\n[Date \"" << date << "\"]\n[Round \"" << index + 1 << "\"]\n";
+		pgn << "[White \"" << white << "\"]\n[Black \"" << black << "\"]\n[Result \"" << result << "\"]\n";
+		if (!fen.empty()) pgn << "[SetUp \"1\"]\n[FEN \"" << fen << "\"]\n";
+		bool timed = config.baseTime && !config.nodes && !config.engines[0].nodes && !config.engines[1].nodes;
+		if (!timed) pgn << "[TimeControl \"-\"]\n";
+		else pgn << "[TimeControl \"" << config.baseTime / 1000.0 << "+" << config.increment / 1000.0 << "\"]\n";
+		pgn << "[Termination \"" << termination << "\"]\n\n" << movetext << "\n\n";
+	}
+
+	os << "Game " << index + 1 << " (" << white << " vs " << black << "): " << result << " {" << termination << "}" << std::endl;
+	os << "Score of " << config.engines[0].name << " vs " << config.engines[1].name << ": " << score.wins << " - "
+		<< score.losses << " - " << score.draws << " [" << score.score() << "] " << finished << std::endl;
+
+	if (config.sprt) {
+		double llr = score.llr(config.elo0, config.elo1);
+		if (llr >= std::log((1 - config.beta) / config.alpha) || llr <= std::log(config.beta / (1 - config.alpha))) stopped = true;
+	}
+}
+
+
+// Reads "key=value" words following an option into 'pairs' and returns the index of the last one used
+static int readPairs(int argc, char** argv, int i, std::vector<std::pair<std::string, std::string>>& pairs) {
+	while (i + 1 < argc && strchr(argv[i + 1], '=')) {
+		std::string word = argv[++i];
+		size_t equals = word.find('=');
+		pairs.push_back({ word.substr(0, equals), word.substr(equals + 1) });
+	}
+	return i;
+}
+
+/*-------------------------------------------------------------------------------------------------------------*\
+* parseTournamentArgs(int, char**, TournamentConfig&)
+*
+* Parameters: argc, argv - Arguments following 'tournament'
+*             config - Filled in from the arguments, left at its defaults for anything not given
+* Description: Options, in the style of other tournament managers:
+*                -engine [name=<name>] [eval=pst|nnue] [nodes=<n>]   given once for each engine
+*                -games <n>  -concurrency <n>  -openings <file>  -pgnout <file>  -hash <mb>  --nnue <file>
+*                -training <file> [-shards]
+*                -tc <seconds>[+<increment>]  or  -nodes <n>
+*                -draw [movenumber=<n>] [movecount=<n>] [score=<cp>]  -resign [movecount=<n>] [score=<cp>]
+*                -sprt [elo0=<elo>] [elo1=<elo>] [alpha=<p>] [beta=<p>]
+* Return Value: False if an option couldn't be read
+\*-------------------------------------------------------------------------------------------------------------*/
+bool parseTournamentArgs(int argc, char** argv, TournamentConfig& config) {
+	int engines = 0;
+	for (int i = 0; i < argc; i++) {
+		std::string option = argv[i];
+		bool hasValue = i + 1 < argc;
+		std::vector<std::pair<std::string, std::string>> pairs;
+
+		if (option == "-engine") {
+			if (engines == 2) {
+				std::cerr << "A match takes exactly two engines" << std::endl;
+				return false;
+			}
+			TournamentEngine& engine = config.engines[engines++];
+			i = readPairs(argc, argv, i, pairs);
+			for (auto& pair : pairs) {
+				if (pair.first == "name") engine.name = pair.second;
+				else if (pair.first == "eval" && (pair.second == "pst" || pair.second == "nnue")) engine.evaluator = pair.second;
+				else if (pair.first == "nodes") engine.nodes = strtoull(pair.second.c_str(), nullptr, 10);
+				else {
+					std::cerr << "Unknown engine setting: " << pair.first << "=" << pair.second << std::endl;
+					return false;
+				}
+			}
+			if (engine.name.empty()) engine.name = engine.evaluator + (engine.nodes ? "-" + std::to_string(engine.nodes) : "");
+		}
+		else if (option == "-games" && hasValue) config.games = std::max(1, atoi(argv[++i]));
+		else if (option == "-concurrency" && hasValue) config.concurrency = std::max(1, atoi(argv[++i]));
+		else if (option == "-openings" && hasValue) config.openingsFile = argv[++i];
+		else if (option == "-pgnout" && hasValue) config.pgnFile = argv[++i];
+		else if (option == "-training" && hasValue) config.trainingFile = argv[++i];
+		else if (option == "-shards") config.trainingShards = true;
+		else if (option == "-hash" && hasValue) config.hashMB = std::min(std::max(atoi(argv[++i]), 1), MAX_HASH_MB);
+		else if (option == "--nnue" && hasValue) config.nnueFile = argv[++i];
+		else if (option == "-nodes" && hasValue) config.nodes = strtoull(argv[++i], nullptr, 10);
+		else if (option == "-tc" && hasValue) {
+			std::string tc = argv[++i];
+			size_t plus = tc.find('+');
+			config.baseTime = (int64_t)(atof(tc.substr(0, plus).c_str()) * 1000);
+			config.increment = (plus == std::string::npos) ? 0 : (int64_t)(atof(tc.substr(plus + 1).c_str()) * 1000);
+		}
+		else if (option == "-draw") {
+			i = readPairs(argc, argv, i, pairs);
+			for (auto& pair : pairs) {
+				if (pair.first == "movenumber") config.drawMoveNumber = atoi(pair.second.c_str());
+				else if (pair.first == "movecount") config.drawCount = atoi(pair.second.c_str());
+				else if (pair.first == "score") config.drawScore = atoi(pair.second.c_str());
+				else std::cerr << "Unknown draw setting: " << pair.first << std::endl;
+			}
+		}
+		else if (option == "-resign") {
+			i = readPairs(argc, argv, i, pairs);
+			for (auto& pair : pairs) {
+				if (pair.first == "movecount") config.resignCount = atoi(pair.second.c_str());
+				else if (pair.first == "score") config.resignScore = atoi(pair.second.c_str());
+				else std::cerr << "Unknown resign setting: " << pair.first << std::endl;
+			}
+		}
+		else if (option == "-sprt") {
+			config.sprt = true;
+			i = readPairs(argc, argv, i, pairs);
+			for (auto& pair : pairs) {
+				if (pair.first == "elo0") config.elo0 = atof(pair.second.c_str());
+				else if (pair.first == "elo1") config.elo1 = atof(pair.second.c_str());
+				else if (pair.first == "alpha") config.alpha = atof(pair.second.c_str());
+				else if (pair.first == "beta") config.beta = atof(pair.second.c_str());
+				else std::cerr << "Unknown SPRT setting: " << pair.first << std::endl;
+			}
+		}
+		else {
+			std::cerr << "Unknown tournament option: " << option << std::endl;
+			return false;
+		}
+	}
+
+	if (engines != 2) {
+		std::cerr << "A match takes exactly two engines" << std::endl;
+		return false;
+	}
+	bool limited = config.nodes || config.baseTime;
+	for (const TournamentEngine& engine : config.engines) {
+		if (!limited && !engine.nodes) {
+			std::cerr << "Every engine needs a clock or a node limit" << std::endl;
+			return false;
+		}
+	}
+	return true;
+}
+
+int runTournament(int argc, char** argv, std::ostream& os) {
+	TournamentConfig config;
+	if (!parseTournamentArgs(argc, argv, config)) return 1;
+	Tournament tournament(config, os);
+	return tournament.run() ? 0 : 1;
+}
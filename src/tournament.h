@@ -0,0 +1,114 @@
+#pragma once
+#include "game.h"
+#include "MiniMaxTree.h"
+#include "TrainingData.h"
+#include <atomic>
+#include <iostream>
+#include <mutex>
+
+// One side of a match. A nonzero 'nodes' fixes its search size per move in place of the clock
+struct TournamentEngine {
+	std::string name;
+	std::string evaluator = "pst";
+	uint64_t nodes = 0;
+};
+
+// Settings for a match between two engines. Times are in milliseconds and a count of 0 turns a rule off
+struct TournamentConfig {
+	TournamentEngine engines[2];
+	int games = 100;
+	int concurrency = 0;			// Games played at once, or 0 for one per hardware thread
+	std::string openingsFile;		// FEN or EPD lines, or PGN games whose moves are played first. Empty for the start
+	int64_t baseTime = 10000;		// Clock per side, or 0 for no clock
+	int64_t increment = 100;
+	uint64_t nodes = 0;				// Nodes per move for both engines, in place of the clock
+	int hashMB = 64;				// Tree memory allowed per search
+
+	// Adjudication: a draw once both sides have scored within 'drawScore' of even for 'drawCount' moves each
+	// from move 'drawMoveNumber' on, and a loss for a side that has scored 'resignScore' or worse for 'resignCount'
+	// moves in a row
+	int drawMoveNumber = 40;
+	int drawCount = 8;
+	int drawScore = 10;
+	int resignCount = 4;
+	int resignScore = 800;
+
+	// Sequential probability ratio test of engines[0] against engines[1]: H0 is a difference of 'elo0', H1 of 'elo1'.
+	// The match ends as soon as one is accepted
+	bool sprt = false;
+	double elo0 = 0.0;
+	double elo1 = 5.0;
+	double alpha = 0.05;
+	double beta = 0.05;
+
+	std::string pgnFile;			// Finished games are appended here when set
+	// Self-play samples: every searched position that isn't in check or scored as a mate, with its score and the
+	// game's result. With 'trainingShards' each worker writes its own file, named by trainingShardPath()
+	std::string trainingFile;
+	bool trainingShards = false;
+	const char* nnueFile = DEFAULT_NNUE_FILE;
+};
+
+// Results from engines[0]'s side
+struct MatchScore {
+	int wins = 0;
+	int draws = 0;
+	int losses = 0;
+
+	int games() const { return wins + draws + losses; }
+	double score() const { return (games()) ? (wins + 0.5 * draws) / games() : 0.5; }
+	double elo() const;
+	// Half the width of the 95% confidence interval on elo()
+	double eloMargin() const;
+	// Likelihood of engines[0] being the stronger one
+	double los() const;
+	// Log likelihood ratio of H1 (a difference of 'elo1') against H0 (a difference of 'elo0')
+	double llr(double elo0, double elo1) const;
+};
+
+// A starting position and the moves played from it before the engines take over
+struct Opening {
+	std::string fen;				// Empty for the standard starting position
+	std::vector<Move> moves;
+};
+
+/*-------------------------------------------------------------------------------------------------------------*\
+* Tournament
+*
+* Description: Plays engine-vs-engine games without the GUI, several at once on worker threads. Every opening is
+*              played twice with the colors swapped. Each worker keeps its own evaluators, so nothing but the
+*              score, the PGN file and the output is shared between games
+\*-------------------------------------------------------------------------------------------------------------*/
+class Tournament {
+	const TournamentConfig config;
+	std::vector<Opening> openings;
+	std::string date;
+
+	std::atomic<int> nextGame{ 0 };
+	std::atomic<bool> stopped{ false };
+	std::mutex resultMutex;
+	MatchScore score;
+	int finished = 0;
+	TrainingWriter training;		// Shared by the workers when the samples aren't sharded
+	uint64_t sampleCount = 0;
+	std::ostream& os;
+
+	bool loadOpenings();
+	void worker(int workerIndex);
+	void playGame(int index, Evaluator* evaluators[2], TrainingWriter* shard);
+	PVLine searchMove(const Game&, Evaluator*, int64_t budget, uint64_t nodes) const;
+	void finishGame(int index, int whiteEngine, const std::string& movetext, const std::string& fen,
+		const char* result, const char* termination, const std::vector<TrainingRecord>& samples);
+
+public:
+	Tournament(const TournamentConfig&, std::ostream& os = std::cout);
+
+	// Plays the match and prints the result. Returns false if the openings couldn't be read
+	bool run();
+	const MatchScore& getScore() const { return score; }
+};
+
+// Reads the match settings from the command line, after 'tournament'. Returns false and says why on a bad argument
+bool parseTournamentArgs(int argc, char** argv, TournamentConfig&);
+// Plays the match described on the command line. Returns the process exit code
+int runTournament(int argc, char** argv, std::ostream& os = std::cout);
@@ -0,0 +1,331 @@
+#include "uci.h"
+#include "MiniMaxTree.h"
+#include "notation.h"
+#include <algorithm>
+#include <chrono>
+#include <sstream>
+
+// Time kept back from every move for the GUI and the operating system, so the engine doesn't lose on time
+constexpr int64_t MOVE_OVERHEAD_MS = 50;
+// Moves left to plan for when the GUI doesn't say
+constexpr int DEFAULT_MOVES_TO_GO = 30;
+// Iterations between info lines when the search depth hasn't changed
+constexpr int INFO_INTERVAL = 4096;
+// Rough memory taken by one tree node: the node, its copy of the game and the parent's map entry
+constexpr size_t TREE_NODE_BYTES = sizeof(MMTNode) + sizeof(Game) + 128;
+
+static const char promotionLetters[7] = { 0, 0, 'n', 'b', 'r', 'q', 0 };
+
+std::string moveToUCI(const Move& move) {
+	std::string text;
+	text += (char)('a' + move.source % 8);
+	text += (char)('1' + move.source / 8);
+	text += (char)('a' + move.target % 8);
+	text += (char)('1' + move.target / 8);
+	if (move.promotion != open) text += promotionLetters[move.promotion];
+	return text;
+}
+
+bool parseUCIMove(Game& game, const std::string& text, Move& move) {
+	if (text.size() < 4 || text.size() > 5) return false;
+	if (text[0] < 'a' || text[0] > 'h' || text[2] < 'a' || text[2] > 'h') return false;
+	if (text[1] < '1' || text[1] > '8' || text[3] < '1' || text[3] > '8') return false;
+	uint8_t source = (text[1] - '1') * 8 + (text[0] - 'a');
+	uint8_t target = (text[3] - '1') * 8 + (text[2] - 'a');
+	PieceType promotion = open;
+	if (text.size() == 5) {
+		const char* letter = std::find(promotionLetters, promotionLetters + 7, (char)tolower(text[4]));
+		if (letter == promotionLetters + 7 || *letter == 0) return false;
+		promotion = (PieceType)(letter - promotionLetters);
+	}
+
+	std::vector<Move> legalMoves;
+	game.getAllLegalMoves(&legalMoves, game.whoseTurn());
+	for (const Move& legal : legalMoves) {
+		if (legal.source == source && legal.target == target && legal.promotion == promotion) {
+			move = legal;
+			return true;
+		}
+	}
+	return false;
+}
+
+int64_t timeBudget(const SearchLimits& limits, Color us) {
+	if (limits.moveTime) return limits.moveTime;
+	int64_t clock = limits.time[colorIndex(us)];
+	if (!clock) return 0;
+
+	int movesToGo = (limits.movesToGo) ? limits.movesToGo : DEFAULT_MOVES_TO_GO;
+	int64_t budget = clock / movesToGo + limits.increment[colorIndex(us)] * 3 / 4;
+	return std::max<int64_t>(1, std::min(budget, clock - MOVE_OVERHEAD_MS));
+}
+
+// A score from the side to move's point of view: "cp <centipawns>", or "mate <moves>" with negative moves when
+// it's the side to move getting mated
+static std::string scoreToUCI(int score) {
+	if (score >= MATE_BOUND) return "mate " + std::to_string((MATE_SCORE - score + 1) / 2);
+	if (score <= -MATE_BOUND) return "mate " + std::to_string(-(MATE_SCORE + score) / 2);
+	return "cp " + std::to_string(score);
+}
+
+UCI::UCI(const std::string& evaluatorName, const char* nnueFile, std::istream& in, std::ostream& out)
+	: in(in), out(out), evaluatorName(evaluatorName), nnueFile(nnueFile) {
+	position = std::make_shared<Game>();
+	evaluator = createEvaluator(evaluatorName, nnueFile);
+}
+
+UCI::~UCI() {
+	waitForSearch();
+}
+
+void UCI::loop() {
+	std::string line;
+	while (std::getline(in, line)) {
+		if (!execute(line)) break;
+	}
+}
+
+void UCI::send(const std::string& line) {
+	std::lock_guard<std::mutex> lock(outputMutex);
+	out << line << std::endl;
+}
+
+void UCI::sendId() {
+	send("id name ChessAI");
+	send("id author the ChessAI developers");
+	send("option name Hash type spin default " + std::to_string(DEFAULT_HASH_MB) + " min 1 max " + std::to_string(MAX_HASH_MB));
+	send("option name Threads type spin default 1 min 1 max " + std::to_string(MAX_THREADS));
+	send("option name MultiPV type spin default 1 min 1 max 256");
+	send("option name Ponder type check default false");
+	send("option name PositionDB type string default <empty>");
+	send("uciok");
+}
+
+/*-------------------------------------------------------------------------------------------------------------*\
+* UCI::execute(const std::string&)
+*
+* Parameters: command - One line from the GUI
+* Description: Runs a UCI command. Anything that changes the position or the options first stops and waits for
+*              a running search, since the search thread reads them
+* Return Value: False after 'quit', true otherwise
+\*-------------------------------------------------------------------------------------------------------------*/
+bool UCI::execute(const std::string& command) {
+	std::istringstream tokens(command);
+	std::string token;
+	if (!(tokens >> token)) return true;
+
+	if (token == "uci") sendId();
+	else if (token == "isready") send("readyok");
+	else if (token == "stop") stopRequested = true;
+	else if (token == "ponderhit") pondering = false;
+	else if (token == "quit") {
+		waitForSearch();
+		return false;
+	}
+	else if (token == "ucinewgame") {
+		waitForSearch();
+		position = std::make_shared<Game>();
+		evaluator = createEvaluator(evaluatorName, nnueFile);
+	}
+	else if (token == "setoption") {
+		waitForSearch();
+		setOption(tokens);
+	}
+	else if (token == "position") {
+		waitForSearch();
+		setPosition(tokens);
+	}
+	else if (token == "go") {
+		waitForSearch();
+		go(tokens);
+	}
+	else if (token == "db") probeDatabase();
+	else send("info string Unknown command: " + command);
+	return true;
+}
+
+// setoption name <name> value <value>. Names are matched without regard to case
+void UCI::setOption(std::istream& tokens) {
+	std::string token, name, value;
+	tokens >> token;
+	while (tokens >> token && token != "value") name += (name.empty() ? "" : " ") + token;
+	while (tokens >> token) value += (value.empty() ? "" : " ") + token;
+	std::transform(name.begin(), name.end(), name.begin(), ::tolower);
+
+	int number = atoi(value.c_str());
+	if (name == "hash") hashMB = std::min(std::max(number, 1), MAX_HASH_MB);
+	else if (name == "threads") threads = std::min(std::max(number, 1), MAX_THREADS);
+	else if (name == "multipv") multiPV = std::max(number, 1);
+	else if (name == "ponder") {}
+	else if (name == "positiondb") {
+		if (value.empty() || value == "<empty>") database.close();
+		else if (!database.open(value)) send("info string Failed to open position database " + value);
+	}
+	else send("info string Unknown option: " + name);
+}
+
+// position (startpos | fen <fen>) [moves ...]
+void UCI::setPosition(std::istream& tokens) {
+	std::string token, fen;
+	tokens >> token;
+	if (token == "fen") {
+		while (tokens >> token && token != "moves") fen += token + " ";
+	}
+	else if (token != "startpos") {
+		send("info string Expected 'startpos' or 'fen'");
+		return;
+	}
+	else tokens >> token;
+
+	std::shared_ptr<Game> game = std::make_shared<Game>();
+	if (!fen.empty() && !game->fromFEN(fen)) {
+		send("info string Invalid FEN: " + fen);
+		return;
+	}
+	position = game;
+
+	while (tokens >> token) {
+		Move move;
+		if (!parseUCIMove(*position, token, move)) {
+			send("info string Illegal move: " + token);
+			return;
+		}
+		position->playMove(move);
+	}
+}
+
+void UCI::go(std::istream& tokens) {
+	SearchLimits limits;
+	std::string token;
+	while (tokens >> token) {
+		if (token == "wtime") tokens >> limits.time[0];
+		else if (token == "btime") tokens >> limits.time[1];
+		else if (token == "winc") tokens >> limits.increment[0];
+		else if (token == "binc") tokens >> limits.increment[1];
+		else if (token == "movestogo") tokens >> limits.movesToGo;
+		else if (token == "depth") tokens >> limits.depth;
+		else if (token == "nodes") tokens >> limits.nodes;
+		else if (token == "mate") tokens >> limits.mate;
+		else if (token == "movetime") tokens >> limits.moveTime;
+		else if (token == "infinite") limits.infinite = true;
+		else if (token == "ponder") limits.ponder = true;
+	}
+
+	// A bare 'go' searches until told to stop
+	if (!limits.time[0] && !limits.time[1] && !limits.moveTime && !limits.depth && !limits.nodes && !limits.mate) {
+		limits.infinite = true;
+	}
+
+	stopRequested = false;
+	pondering = limits.ponder;
+	searchThread = std::thread(&UCI::search, this, limits, std::make_shared<Game>(position));
+}
+
+// Not part of UCI: prints the games the position database has through the current position, as info strings
+void UCI::probeDatabase() {
+	if (!database.isOpen()) {
+		send("info string No position database; set the PositionDB option");
+		return;
+	}
+	const PositionDBEntry* entry = database.find(*position);
+	if (!entry) {
+		send("info string Position not in the database");
+		return;
+	}
+	send("info string games " + std::to_string(entry->games()) + " white " + std::to_string(entry->whiteWins)
+		+ " draws " + std::to_string(entry->draws) + " black " + std::to_string(entry->blackWins));
+	for (const PositionDBMove& move : database.getMoves(entry)) {
+		Move played = move.toMove(*position);
+		send("info string move " + moveToUCI(played) + " " + toSAN(*position, played) + " count " + std::to_string(move.count));
+	}
+}
+
+void UCI::waitForSearch() {
+	if (!searchThread.joinable()) return;
+	stopRequested = true;
+	searchThread.join();
+}
+
+/*-------------------------------------------------------------------------------------------------------------*\
+* UCI::search(SearchLimits, std::shared_ptr<Game>)
+*
+* Parameters: limits - Limits from the 'go' command
+*             root - Copy of the position to search
+* Description: Runs on the search thread. Grows the tree until a limit is hit, the tree fills the Hash size or
+*              'stop' arrives, reporting info lines as the search deepens. Pondering and infinite searches hold
+*              back their bestmove until the GUI sends 'stop' or 'ponderhit'. The clock starts over on 'ponderhit'
+\*-------------------------------------------------------------------------------------------------------------*/
+void UCI::search(SearchLimits limits, std::shared_ptr<Game> root) {
+	typedef std::chrono::steady_clock Clock;
+	Clock::time_point start = Clock::now();
+	Color us = root->whoseTurn();
+
+	std::vector<Move> legalMoves;
+	root->getAllLegalMoves(&legalMoves, us);
+	std::vector<PVLine> lines;
+
+	if (!legalMoves.empty()) {
+		MMTNode rootNode(root, 0, us, evaluator.get());
+		MiniMaxTree tree(&rootNode);
+		tree.setMultiPV(multiPV);
+
+		int64_t budget = timeBudget(limits, us);
+		uint64_t depthLimit = (limits.mate) ? 2 * limits.mate - 1 : limits.depth;
+		uint64_t maxNodes = std::max<uint64_t>(1, ((uint64_t)hashMB << 20) / TREE_NODE_BYTES);
+		bool waitingForPonderHit = limits.ponder;
+		uint64_t reportedDepth = 0;
+		uint64_t lastNodes = 0;
+
+		auto report = [&](const std::vector<PVLine>& lines, int64_t elapsed) {
+			const SearchStats& stats = tree.getStats();
+			for (size_t i = 0; i < lines.size(); i++) {
+				std::string info = "info depth " + std::to_string(lines[i].pv.size()) + " seldepth " + std::to_string(stats.maxDepth)
+					+ " multipv " + std::to_string(i + 1) + " score " + scoreToUCI(lines[i].score * us)
+					+ " nodes " + std::to_string(stats.nodes) + " nps " + std::to_string((uint64_t)stats.nodesPerSecond())
+					+ " time " + std::to_string(elapsed) + " pv";
+				for (const Move& move : lines[i].pv) info += " " + moveToUCI(move);
+				send(info);
+			}
+		};
+
+		tree.search(UINT64_MAX, [&](int iteration, const std::vector<PVLine>& current) {
+			const SearchStats& stats = tree.getStats();
+			Clock::time_point now = Clock::now();
+			if (waitingForPonderHit && !pondering) {
+				waitingForPonderHit = false;
+				start = now;
+			}
+			int64_t elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(now - start).count();
+
+			if (stats.maxDepth > reportedDepth || iteration % INFO_INTERVAL == 0) {
+				reportedDepth = stats.maxDepth;
+				report(current, elapsed);
+			}
+
+			// Limits only count once the GUI is waiting on a move. An iteration that adds no nodes found only mates,
+			// stalemates and repetitions at the end of the lines it followed, so searching on changes nothing
+			bool limited = !limits.infinite && !pondering;
+			bool converged = stats.nodes == lastNodes;
+			lastNodes = stats.nodes;
+			if (stopRequested || converged || stats.nodes >= maxNodes
+				|| (limited && budget && elapsed >= budget)
+				|| (limited && limits.nodes && stats.nodes >= limits.nodes)
+				|| (limited && depthLimit && stats.maxDepth >= depthLimit)) {
+				tree.stop();
+			}
+		});
+
+		lines = tree.getLines();
+		report(lines, std::chrono::duration_cast<std::chrono::milliseconds>(Clock::now() - start).count());
+	}
+
+	// The GUI expects no bestmove from an infinite search or a ponder search until it says so
+	while ((limits.infinite || pondering) && !stopRequested) {
+		std::this_thread::sleep_for(std::chrono::milliseconds(1));
+	}
+	pondering = false;
+
+	if (lines.empty()) send("bestmove 0000");
+	else if (lines[0].pv.size() > 1) send("bestmove " + moveToUCI(lines[0].move) + " ponder " + moveToUCI(lines[0].pv[1]));
+	else send("bestmove " + moveToUCI(lines[0].move));
+}
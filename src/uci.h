@@ -0,0 +1,75 @@
+#pragma once
+#include "game.h"
+#include "Evaluator.h"
+#include "PositionDB.h"
+#include <atomic>
+#include <mutex>
+#include <thread>
+
+constexpr int DEFAULT_HASH_MB = 256;
+constexpr int MAX_HASH_MB = 4096;
+constexpr int MAX_THREADS = 256;
+
+// Limits given to 'go'. Times are in milliseconds and 0 means no limit
+struct SearchLimits {
+	int64_t time[2] = { 0, 0 };			// Clock left, indexed white, black
+	int64_t increment[2] = { 0, 0 };
+	int movesToGo = 0;
+	int depth = 0;
+	uint64_t nodes = 0;
+	int mate = 0;
+	int64_t moveTime = 0;
+	bool infinite = false;
+	bool ponder = false;
+};
+
+// Coordinate notation used by UCI: source square, target square and the promotion piece if any, such as "e7e8q"
+std::string moveToUCI(const Move&);
+// Finds the legal move written as 'text' in 'game'. Returns false if there isn't one
+bool parseUCIMove(Game& game, const std::string& text, Move& move);
+// Milliseconds 'us' should spend on this move, or 0 when the clock doesn't limit the search
+int64_t timeBudget(const SearchLimits&, Color us);
+
+/*-------------------------------------------------------------------------------------------------------------*\
+* UCI
+*
+* Description: Speaks the Universal Chess Interface over a pair of streams, normally stdin and stdout. Searches
+*              run on their own thread so 'stop', 'ponderhit' and 'isready' are answered while one is running
+\*-------------------------------------------------------------------------------------------------------------*/
+class UCI {
+	std::istream& in;
+	std::ostream& out;
+	std::mutex outputMutex;
+
+	std::shared_ptr<Game> position;
+	std::shared_ptr<Evaluator> evaluator;
+	std::string evaluatorName;
+	const char* nnueFile;
+	int hashMB = DEFAULT_HASH_MB;
+	int threads = 1;
+	int multiPV = 1;
+	// Opened with the PositionDB option and queried with the 'db' command
+	PositionDB database;
+
+	std::thread searchThread;
+	std::atomic<bool> stopRequested{ false };
+	std::atomic<bool> pondering{ false };
+
+	void send(const std::string&);
+	void sendId();
+	void setOption(std::istream&);
+	void setPosition(std::istream&);
+	void go(std::istream&);
+	void probeDatabase();
+	void search(SearchLimits, std::shared_ptr<Game>);
+	void waitForSearch();
+
+public:
+	UCI(const std::string& evaluatorName = "pst", const char* nnueFile = DEFAULT_NNUE_FILE,
+		std::istream& in = std::cin, std::ostream& out = std::cout);
+	~UCI();
+
+	void loop();
+	// Runs one command. Returns false once told to quit
+	bool execute(const std::string& command);
+};
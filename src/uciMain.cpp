@@ -0,0 +1,64 @@
+// Entry point for the headless engine: speaks UCI on stdin/stdout and links none of the graphics libraries
+
+#include "uci.h"
+#include "bench.h"
+#include "epd.h"
+#include "pgn.h"
+#include "PositionDB.h"
+#include "server.h"
+#include "tournament.h"
+#include "TrainingData.h"
+#include <cstring>
+
+
+int main(int argc, char** argv) {
+	// Same arguments as the windowed program: ChessAI-UCI [bench] [--nnue <file>], plus ChessAI-UCI pgn <file>,
+	// ChessAI-UCI tournament <options>, ChessAI-UCI epd <file> <options>, ChessAI-UCI training <file>,
+	// ChessAI-UCI db (build | probe) <files> and ChessAI-UCI server <options>
+	std::string evaluatorName = "pst";
+	const char* nnueFile = DEFAULT_NNUE_FILE;
+	for (int i = 1; i + 1 < argc; i++) {
+		if (strcmp(argv[i], "--nnue") == 0) {
+			evaluatorName = "nnue";
+			nnueFile = argv[i + 1];
+		}
+	}
+
+	if (argc > 1 && strcmp(argv[1], "bench") == 0) {
+		return runBenchmark((evaluatorName == "nnue") ? nnueFile : nullptr);
+	}
+
+	// Replays every game in a PGN file and reports the ingestion rate
+	if (argc > 2 && strcmp(argv[1], "pgn") == 0) {
+		return runPGNIngest(argv[2]);
+	}
+
+	// Reads back a training data file and reports what's in it
+	if (argc > 2 && strcmp(argv[1], "training") == 0) {
+		return runTrainingStats(argv[2]);
+	}
+
+	// Builds or queries a position database; see runPositionDB() for the arguments
+	if (argc > 1 && strcmp(argv[1], "db") == 0) {
+		return runPositionDB(argc - 2, argv + 2);
+	}
+
+	// Runs an EPD test suite; see runEPDSuite() for the options
+	if (argc > 1 && strcmp(argv[1], "epd") == 0) {
+		return runEPDSuite(argc - 2, argv + 2);
+	}
+
+	// Plays an engine-vs-engine match; see parseTournamentArgs() for the options
+	if (argc > 1 && strcmp(argv[1], "tournament") == 0) {
+		return runTournament(argc - 2, argv + 2);
+	}
+
+	// Hosts games for clients on a local socket; see parseServerArgs() for the options
+	if (argc > 1 && strcmp(argv[1], "server") == 0) {
+		return runGameServer(argc - 2, argv + 2);
+	}
+
+	UCI uci(evaluatorName, nnueFile);
+	uci.loop();
+	return 0;
+}
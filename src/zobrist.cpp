@@ -0,0 +1,23 @@
+#include "zobrist.h"
+
+// SplitMix64, seeded with a constant so hashes are the same on every run
+static uint64_t nextRandom(uint64_t& state) {
+	uint64_t z = (state += 0x9E3779B97F4A7C15ULL);
+	z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+	z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+	return z ^ (z >> 31);
+}
+
+ZobristKeys::ZobristKeys() {
+	uint64_t state = 0x1234567890ABCDEFULL;
+	for (int color = 0; color < 2; color++) {
+		for (int type = 0; type < 7; type++) {
+			for (int square = 0; square < 64; square++) {
+				pieces[color][type][square] = (type == open) ? 0 : nextRandom(state);
+			}
+		}
+	}
+	for (int rights = 0; rights < 16; rights++) castling[rights] = nextRandom(state);
+	for (int file = 0; file < 8; file++) enPassant[file] = nextRandom(state);
+	blackToMove = nextRandom(state);
+}
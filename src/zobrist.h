@@ -0,0 +1,21 @@
+#pragma once
+#include "util.h"
+
+// Random keys used to hash positions
+struct ZobristKeys {
+	uint64_t pieces[2][7][64];
+	uint64_t castling[16];		// Indexed by the castling bits of the game status
+	uint64_t enPassant[8];		// By file of the en passant square
+	uint64_t blackToMove;
+
+	ZobristKeys();
+};
+
+inline const ZobristKeys& zobrist() {
+	static const ZobristKeys keys;
+	return keys;
+}
+
+inline uint64_t pieceKey(Color color, PieceType type, int square) {
+	return zobrist().pieces[(color == white) ? 0 : 1][type][square];
+}